@@ -0,0 +1,173 @@
+#include "BitBoard.h"
+#include <algorithm>
+#include <cstdlib>
+
+BitBoard::BitBoard() : area{0, 0, 0, 0}, wordsPerRow(0) {}
+
+BitBoard::BitBoard(const SDL_Rect& area) : BitBoard() {
+    reset(area);
+}
+
+void BitBoard::reset(const SDL_Rect& newArea) {
+    area = {newArea.x, newArea.y, std::max(0, newArea.w), std::max(0, newArea.h)};
+    wordsPerRow = (area.w + 63) / 64;
+    bits.assign(static_cast<size_t>(wordsPerRow) * area.h, 0);
+}
+
+void BitBoard::set(int x, int y) {
+    if (contains(x, y)) {
+        const int bit = x - area.x;
+        rowWords(y)[bit >> 6] |= uint64_t(1) << (bit & 63);
+    }
+}
+
+void BitBoard::clear(int x, int y) {
+    if (contains(x, y)) {
+        const int bit = x - area.x;
+        rowWords(y)[bit >> 6] &= ~(uint64_t(1) << (bit & 63));
+    }
+}
+
+void BitBoard::setRun(int y, int firstX, int endX) {
+    if (y < area.y || y >= area.y + area.h || wordsPerRow == 0) {
+        return;
+    }
+    int first = std::max(firstX, area.x) - area.x;
+    const int end = std::min(endX, area.x + area.w) - area.x;
+    uint64_t* words = rowWords(y);
+    while (first < end) {
+        const int span = std::min(end - first, 64 - (first & 63));
+        const uint64_t mask = span == 64 ? ~uint64_t(0) : ((uint64_t(1) << span) - 1) << (first & 63);
+        words[first >> 6] |= mask;
+        first += span;
+    }
+}
+
+void BitBoard::orWord(int x, int y, uint64_t value) {
+    if (y < area.y || y >= area.y + area.h || wordsPerRow == 0 || value == 0) {
+        return;
+    }
+    int offset = x - area.x;
+    if (offset <= -64 || offset >= area.w) {
+        return;
+    }
+    if (offset < 0) {
+        value >>= -offset;
+        offset = 0;
+    }
+    uint64_t* words = rowWords(y);
+    const int word = offset >> 6;
+    const int shift = offset & 63;
+    words[word] |= value << shift;
+    if (shift != 0 && word + 1 < wordsPerRow) {
+        words[word + 1] |= value >> (64 - shift);
+    }
+    words[wordsPerRow - 1] &= lastWordMask();
+}
+
+uint64_t BitBoard::wordAt(int x, int y) const {
+    if (y < area.y || y >= area.y + area.h || wordsPerRow == 0) {
+        return 0;
+    }
+    const int offset = x - area.x;
+    if (offset <= -64 || offset >= area.w) {
+        return 0;
+    }
+    const uint64_t* words = rowWords(y);
+    if (offset < 0) {
+        return words[0] << -offset;
+    }
+    const int word = offset >> 6;
+    const int shift = offset & 63;
+    uint64_t value = words[word] >> shift;
+    if (shift != 0 && word + 1 < wordsPerRow) {
+        value |= words[word + 1] << (64 - shift);
+    }
+    return value;
+}
+
+BitBoard& BitBoard::operator&=(const BitBoard& other) {
+    if (wordsPerRow == 0) {
+        return *this;
+    }
+    for (int row = 0; row < area.h; ++row) {
+        uint64_t* words = rowWords(area.y + row);
+        for (int word = 0; word < wordsPerRow; ++word) {
+            words[word] &= other.wordAt(area.x + word * 64, area.y + row);
+        }
+    }
+    return *this;
+}
+
+BitBoard& BitBoard::operator|=(const BitBoard& other) {
+    if (wordsPerRow == 0) {
+        return *this;
+    }
+    for (int row = 0; row < area.h; ++row) {
+        uint64_t* words = rowWords(area.y + row);
+        for (int word = 0; word < wordsPerRow; ++word) {
+            words[word] |= other.wordAt(area.x + word * 64, area.y + row);
+        }
+        words[wordsPerRow - 1] &= lastWordMask();
+    }
+    return *this;
+}
+
+BitBoard& BitBoard::andNot(const BitBoard& other) {
+    if (wordsPerRow == 0) {
+        return *this;
+    }
+    for (int row = 0; row < area.h; ++row) {
+        uint64_t* words = rowWords(area.y + row);
+        for (int word = 0; word < wordsPerRow; ++word) {
+            words[word] &= ~other.wordAt(area.x + word * 64, area.y + row);
+        }
+    }
+    return *this;
+}
+
+void BitBoard::clearAll() {
+    std::fill(bits.begin(), bits.end(), 0);
+}
+
+bool BitBoard::any() const {
+    for (uint64_t word : bits) {
+        if (word) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t BitBoard::count() const {
+    size_t total = 0;
+    for (uint64_t word : bits) {
+        total += static_cast<size_t>(__builtin_popcountll(word));
+    }
+    return total;
+}
+
+std::vector<SDL_Point> BitBoard::toPoints() const {
+    std::vector<SDL_Point> points;
+    points.reserve(count());
+    forEach([&](int x, int y) { points.push_back({x, y}); });
+    return points;
+}
+
+BitBoard BitBoard::diamond(const SDL_Point& center, int radius, const SDL_Rect& clip) {
+    const int left = std::max(clip.x, center.x - radius);
+    const int top = std::max(clip.y, center.y - radius);
+    const int right = std::min(clip.x + clip.w, center.x + radius + 1);
+    const int bottom = std::min(clip.y + clip.h, center.y + radius + 1);
+    BitBoard board({left, top, right - left, bottom - top});
+    for (int y = top; y < bottom; ++y) {
+        const int span = radius - std::abs(y - center.y);
+        board.setRun(y, center.x - span, center.x + span + 1);
+    }
+    return board;
+}
+
+uint64_t BitBoard::lastWordMask() const {
+    const int used = area.w & 63;
+    return used == 0 ? ~uint64_t(0) : (uint64_t(1) << used) - 1;
+}
@@ -0,0 +1,76 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <SDL2/SDL.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// One bit per tile over a rectangle of the map, each row packed into 64-bit
+// words starting at the rectangle's left edge. Boards over different
+// rectangles combine word by word; tiles outside a board read as clear.
+class BitBoard {
+public:
+    BitBoard();
+    explicit BitBoard(const SDL_Rect& area);
+
+    // Resizes to `area` and clears every bit.
+    void reset(const SDL_Rect& area);
+    const SDL_Rect& getArea() const { return area; }
+
+    bool test(int x, int y) const {
+        if (!contains(x, y)) {
+            return false;
+        }
+        const int bit = x - area.x;
+        return (rowWords(y)[bit >> 6] >> (bit & 63)) & 1;
+    }
+    void set(int x, int y);
+    void clear(int x, int y);
+    // Sets tiles [firstX, endX) of row y, clipped to the board.
+    void setRun(int y, int firstX, int endX);
+    // ORs in 64 tiles starting at x; bit i is tile x + i.
+    void orWord(int x, int y, uint64_t bits);
+    // The 64 tiles starting at x, in the same layout as orWord.
+    uint64_t wordAt(int x, int y) const;
+
+    BitBoard& operator&=(const BitBoard& other);
+    BitBoard& operator|=(const BitBoard& other);
+    BitBoard& andNot(const BitBoard& other);
+    void clearAll();
+
+    bool any() const;
+    size_t count() const;
+    std::vector<SDL_Point> toPoints() const;
+
+    template <typename Visit>
+    void forEach(Visit visit) const {
+        for (int row = 0; row < area.h; ++row) {
+            const uint64_t* words = bits.data() + static_cast<size_t>(row) * wordsPerRow;
+            for (int word = 0; word < wordsPerRow; ++word) {
+                uint64_t value = words[word];
+                while (value) {
+                    visit(area.x + word * 64 + __builtin_ctzll(value), area.y + row);
+                    value &= value - 1;
+                }
+            }
+        }
+    }
+
+    // Tiles within Manhattan distance `radius` of center, clipped to `clip`.
+    static BitBoard diamond(const SDL_Point& center, int radius, const SDL_Rect& clip);
+
+private:
+    SDL_Rect area;
+    int wordsPerRow;
+    std::vector<uint64_t> bits;
+
+    bool contains(int x, int y) const {
+        return x >= area.x && y >= area.y && x < area.x + area.w && y < area.y + area.h;
+    }
+    uint64_t* rowWords(int y) { return bits.data() + static_cast<size_t>(y - area.y) * wordsPerRow; }
+    const uint64_t* rowWords(int y) const { return bits.data() + static_cast<size_t>(y - area.y) * wordsPerRow; }
+    uint64_t lastWordMask() const;
+};
+
+#endif
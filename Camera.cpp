@@ -0,0 +1,108 @@
+#include "Camera.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const float kMinZoom = 0.5f;
+const float kMaxZoom = 3.0f;
+}
+
+Camera::Camera()
+    : viewport{0, 0, 0, 0}, boardWide(0), boardHigh(0), tileSize(32), zoom(1.0f), offsetX(0.0f), offsetY(0.0f) {}
+
+void Camera::setViewport(const SDL_Rect& area) {
+    viewport = area;
+    clampOffset();
+}
+
+void Camera::setBoard(int tilesWide, int tilesHigh, int tilePixels) {
+    boardWide = tilesWide;
+    boardHigh = tilesHigh;
+    tileSize = std::max(1, tilePixels);
+    clampOffset();
+}
+
+void Camera::pan(int screenDX, int screenDY) {
+    offsetX += screenDX / zoom;
+    offsetY += screenDY / zoom;
+    clampOffset();
+}
+
+void Camera::zoomAt(float factor, int screenX, int screenY) {
+    float boardX = offsetX + (screenX - viewport.x) / zoom;
+    float boardY = offsetY + (screenY - viewport.y) / zoom;
+    zoom = std::min(kMaxZoom, std::max(kMinZoom, zoom * factor));
+    offsetX = boardX - (screenX - viewport.x) / zoom;
+    offsetY = boardY - (screenY - viewport.y) / zoom;
+    clampOffset();
+}
+
+void Camera::centerOn(int tileX, int tileY) {
+    offsetX = (tileX + 0.5f) * tileSize - viewport.w / (2.0f * zoom);
+    offsetY = (tileY + 0.5f) * tileSize - viewport.h / (2.0f * zoom);
+    clampOffset();
+}
+
+void Camera::ensureVisible(int tileX, int tileY) {
+    SDL_Rect rect = tileToScreen(tileX, tileY);
+    if (rect.x < viewport.x || rect.y < viewport.y ||
+        rect.x + rect.w > viewport.x + viewport.w || rect.y + rect.h > viewport.y + viewport.h) {
+        centerOn(tileX, tileY);
+    }
+}
+
+SDL_Rect Camera::getVisibleTiles() const {
+    int firstX = std::max(0, static_cast<int>(std::floor(offsetX / tileSize)));
+    int firstY = std::max(0, static_cast<int>(std::floor(offsetY / tileSize)));
+    int lastX = std::min(boardWide - 1, static_cast<int>(std::ceil((offsetX + viewport.w / zoom) / tileSize)) - 1);
+    int lastY = std::min(boardHigh - 1, static_cast<int>(std::ceil((offsetY + viewport.h / zoom) / tileSize)) - 1);
+    if (lastX < firstX || lastY < firstY) {
+        return {0, 0, 0, 0};
+    }
+    return {firstX, firstY, lastX - firstX + 1, lastY - firstY + 1};
+}
+
+bool Camera::isTileVisible(int tileX, int tileY) const {
+    SDL_Rect visible = getVisibleTiles();
+    return tileX >= visible.x && tileY >= visible.y && tileX < visible.x + visible.w && tileY < visible.y + visible.h;
+}
+
+bool Camera::screenToTile(int screenX, int screenY, int& tileX, int& tileY) const {
+    if (screenX < viewport.x || screenY < viewport.y ||
+        screenX >= viewport.x + viewport.w || screenY >= viewport.y + viewport.h) {
+        return false;
+    }
+    float boardX = offsetX + (screenX - viewport.x) / zoom;
+    float boardY = offsetY + (screenY - viewport.y) / zoom;
+    if (boardX < 0.0f || boardY < 0.0f) {
+        return false;
+    }
+    tileX = static_cast<int>(boardX / tileSize);
+    tileY = static_cast<int>(boardY / tileSize);
+    return tileX < boardWide && tileY < boardHigh;
+}
+
+SDL_Rect Camera::tileToScreen(int tileX, int tileY) const {
+    int left = toScreenX(static_cast<float>(tileX) * tileSize);
+    int top = toScreenY(static_cast<float>(tileY) * tileSize);
+    int right = toScreenX(static_cast<float>(tileX + 1) * tileSize);
+    int bottom = toScreenY(static_cast<float>(tileY + 1) * tileSize);
+    return {left, top, right - left, bottom - top};
+}
+
+int Camera::toScreenX(float boardX) const {
+    return viewport.x + static_cast<int>(std::floor((boardX - offsetX) * zoom));
+}
+
+int Camera::toScreenY(float boardY) const {
+    return viewport.y + static_cast<int>(std::floor((boardY - offsetY) * zoom));
+}
+
+void Camera::clampOffset() {
+    const float visibleW = viewport.w / zoom;
+    const float visibleH = viewport.h / zoom;
+    const float boardW = static_cast<float>(boardWide) * tileSize;
+    const float boardH = static_cast<float>(boardHigh) * tileSize;
+    offsetX = boardW <= visibleW ? (boardW - visibleW) / 2.0f : std::min(std::max(offsetX, 0.0f), boardW - visibleW);
+    offsetY = boardH <= visibleH ? (boardH - visibleH) / 2.0f : std::min(std::max(offsetY, 0.0f), boardH - visibleH);
+}
@@ -0,0 +1,44 @@
+#ifndef CAMERA_H
+#define CAMERA_H
+
+#include <SDL2/SDL.h>
+
+// Maps board tiles to screen pixels inside a viewport. The offset is the
+// board position, in unzoomed pixels, shown at the viewport's top-left
+// corner; boards smaller than the viewport are centered.
+class Camera {
+public:
+    Camera();
+
+    void setViewport(const SDL_Rect& area);
+    void setBoard(int tilesWide, int tilesHigh, int tilePixels);
+    void pan(int screenDX, int screenDY);
+    // Keeps the board point under the given screen position in place.
+    void zoomAt(float factor, int screenX, int screenY);
+    void centerOn(int tileX, int tileY);
+    void ensureVisible(int tileX, int tileY);
+
+    const SDL_Rect& getViewport() const { return viewport; }
+    float getZoom() const { return zoom; }
+    // Tiles at least partly inside the viewport, clipped to the board.
+    SDL_Rect getVisibleTiles() const;
+    bool isTileVisible(int tileX, int tileY) const;
+    bool screenToTile(int screenX, int screenY, int& tileX, int& tileY) const;
+    // Adjacent tiles share edges exactly, whatever the zoom.
+    SDL_Rect tileToScreen(int tileX, int tileY) const;
+
+private:
+    SDL_Rect viewport;
+    int boardWide;
+    int boardHigh;
+    int tileSize;
+    float zoom;
+    float offsetX;
+    float offsetY;
+
+    int toScreenX(float boardX) const;
+    int toScreenY(float boardY) const;
+    void clampOffset();
+};
+
+#endif
@@ -50,17 +50,17 @@ bool CombatSystem::useAbility(const AbilityDefinition& ability, Entity& user, En
         }
         break;
     case AbilityEffectType::Buff:
-        user.addStatus("buff_" + ability.id, 3);
+        user.addStatus(ability.statusId, 3);
         log.addEntry(user.getName() + " gains a buff from " + ability.name);
         break;
     case AbilityEffectType::Debuff:
         if (target) {
-            target->addStatus("debuff_" + ability.id, 3);
+            target->addStatus(ability.statusId, 3);
             log.addEntry(target->getName() + " suffers a debuff from " + ability.name);
         }
         break;
     case AbilityEffectType::Status:
-        user.addStatus(ability.id, 2);
+        user.addStatus(ability.statusId, 2);
         log.addEntry(user.getName() + " activates " + ability.name);
         break;
     }
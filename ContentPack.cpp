@@ -0,0 +1,833 @@
+#include "ContentPack.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/stat.h>
+#include <type_traits>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+enum PackSection {
+    kStrings,
+    kStringRefs,
+    kLists,
+    kTerrain,
+    kAbilities,
+    kItems,
+    kEntities,
+    kMaps,
+    kSpecials,
+    kObjectives,
+    kPoints,
+    kCells,
+    kDigests,
+    kSectionCount
+};
+
+struct PackString {
+    uint32_t offset;
+    uint32_t length;
+};
+
+struct PackList {
+    uint32_t first;
+    uint32_t count;
+};
+
+struct PackTerrain {
+    PackString id;
+    PackString name;
+    int32_t movementCost;
+    int32_t defenseModifier;
+    int32_t dodgeModifier;
+    uint8_t blocksMovement;
+    uint8_t blocksLineOfSight;
+    uint8_t color[4];
+    uint8_t padding[2];
+};
+
+struct PackAbility {
+    PackString id;
+    PackString name;
+    PackString description;
+    int32_t apCost;
+    int32_t energyCost;
+    int32_t range;
+    int32_t targetType;
+    int32_t effectType;
+    int32_t power;
+};
+
+struct PackItem {
+    PackString id;
+    PackString name;
+    PackString description;
+};
+
+struct PackEntity {
+    PackString id;
+    PackString name;
+    PackString dialog;
+    int32_t kind;
+    int32_t faction;
+    int32_t strength;
+    int32_t agility;
+    int32_t intelligence;
+    int32_t defense;
+    int32_t maxHP;
+    int32_t maxEnergy;
+    int32_t baseAttack;
+    int32_t attackRange;
+    PackList abilityIds;
+    PackList passiveEffects;
+};
+
+struct PackSpecial {
+    int32_t type;
+    int32_t x;
+    int32_t y;
+    int32_t value;
+    PackString targetId;
+    int32_t targetX;
+    int32_t targetY;
+};
+
+struct PackObjective {
+    int32_t type;
+    PackString description;
+    PackString targetId;
+    int32_t amount;
+    int32_t turnLimit;
+    int32_t targetX;
+    int32_t targetY;
+};
+
+struct PackPoint {
+    int32_t x;
+    int32_t y;
+};
+
+// Terrain rows are stored as indices into a per-map palette of terrain ids;
+// `rows` lists one cell range per source row, so ragged rows survive.
+struct PackMap {
+    PackString id;
+    PackString name;
+    PackString rhythm;
+    int32_t width;
+    int32_t height;
+    int32_t mode;
+    int32_t turnLimit;
+    PackList palette;
+    PackList rows;
+    PackList specials;
+    PackList objectives;
+    PackList loseConditions;
+    PackList playerIds;
+    PackList enemyIds;
+    PackList npcIds;
+    PackList playerSpawns;
+    PackList enemySpawns;
+    PackList npcSpawns;
+};
+
+struct PackDigest {
+    uint32_t section;
+    uint32_t reserved;
+    uint64_t hash;
+};
+
+struct PackSpan {
+    uint64_t offset;
+    uint64_t count;
+};
+
+const char kMagic[4] = {'E', 'D', 'P', 'K'};
+
+class PackWriter {
+public:
+    PackString addString(std::string_view text) {
+        std::string key(text);
+        auto it = stringIndex.find(key);
+        if (it != stringIndex.end()) {
+            return it->second;
+        }
+        PackString ref = {static_cast<uint32_t>(strings.size()), static_cast<uint32_t>(text.size())};
+        strings.insert(strings.end(), text.begin(), text.end());
+        stringIndex.emplace(std::move(key), ref);
+        return ref;
+    }
+
+    PackString addSymbol(Symbol symbol) {
+        return addString(symbolName(symbol));
+    }
+
+    PackList addStringList(const std::vector<std::string>& values) {
+        PackList list = {static_cast<uint32_t>(stringRefs.size()), static_cast<uint32_t>(values.size())};
+        for (const auto& value : values) {
+            stringRefs.push_back(addString(value));
+        }
+        return list;
+    }
+
+    PackList addSymbolList(const std::vector<Symbol>& values) {
+        PackList list = {static_cast<uint32_t>(stringRefs.size()), static_cast<uint32_t>(values.size())};
+        for (Symbol value : values) {
+            stringRefs.push_back(addSymbol(value));
+        }
+        return list;
+    }
+
+    PackList addPoints(const std::vector<SDL_Point>& values) {
+        PackList list = {static_cast<uint32_t>(points.size()), static_cast<uint32_t>(values.size())};
+        for (const auto& value : values) {
+            points.push_back({value.x, value.y});
+        }
+        return list;
+    }
+
+    std::vector<char> strings;
+    std::vector<PackString> stringRefs;
+    std::vector<PackList> lists;
+    std::vector<PackTerrain> terrain;
+    std::vector<PackAbility> abilities;
+    std::vector<PackItem> items;
+    std::vector<PackEntity> entities;
+    std::vector<PackMap> maps;
+    std::vector<PackSpecial> specials;
+    std::vector<PackObjective> objectives;
+    std::vector<PackPoint> points;
+    std::vector<uint16_t> cells;
+    std::vector<PackDigest> digests;
+
+private:
+    std::unordered_map<std::string, PackString> stringIndex;
+};
+
+size_t alignTo(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+class PackTerrainSource : public MapTerrainSource {
+public:
+    PackTerrainSource(std::shared_ptr<const ContentPack> pack, size_t recordIndex)
+        : pack(std::move(pack)), recordIndex(recordIndex) {}
+
+    bool readTerrain(int x, int y, int width, int height, std::vector<Symbol>& ids) const override {
+        return pack->readTerrain(recordIndex, x, y, width, height, ids);
+    }
+
+private:
+    std::shared_ptr<const ContentPack> pack;
+    size_t recordIndex;
+};
+}
+
+struct ContentPack::Header {
+    char magic[4];
+    uint32_t version;
+    uint64_t sourceHash;
+    uint64_t sourceSize;
+    int64_t sourceModifiedTime;
+    PackSpan sections[kSectionCount];
+};
+
+std::string ContentPack::pathFor(const std::string& sourcePath) {
+    size_t slash = sourcePath.find_last_of('/');
+    size_t dot = sourcePath.find_last_of('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return sourcePath + ".edpak";
+    }
+    return sourcePath.substr(0, dot) + ".edpak";
+}
+
+bool ContentPack::statSource(const std::string& sourcePath, ContentSourceStamp& stamp) {
+    struct stat info;
+    if (stat(sourcePath.c_str(), &info) != 0) {
+        return false;
+    }
+    stamp.size = static_cast<uint64_t>(info.st_size);
+    stamp.modifiedTime = static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000LL + info.st_mtim.tv_nsec;
+    return true;
+}
+
+uint64_t ContentPack::hashBytes(std::string_view bytes) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (unsigned char c : bytes) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+namespace {
+// Records are written by id name so the pack bytes do not depend on hash map
+// order, which varies with the order symbols were interned in.
+template <typename Definition>
+std::vector<const Definition*> sortedById(const SymbolMap<Definition>& definitions) {
+    std::vector<const Definition*> sorted;
+    sorted.reserve(definitions.size());
+    for (const auto& entry : definitions) {
+        sorted.push_back(&entry.second);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const Definition* a, const Definition* b) {
+        return symbolName(a->id) < symbolName(b->id);
+    });
+    return sorted;
+}
+}
+
+bool ContentPack::write(const std::string& packPath, const GameContent& content, const ContentSourceStamp& stamp,
+                        const std::vector<ContentRecordDigest>& digests) {
+    PackWriter writer;
+
+    for (const TerrainTypeDefinition* entry : sortedById(content.terrainTypes)) {
+        const TerrainTypeDefinition& def = *entry;
+        PackTerrain record = {};
+        record.id = writer.addSymbol(def.id);
+        record.name = writer.addString(def.name);
+        record.movementCost = def.movementCost;
+        record.defenseModifier = def.defenseModifier;
+        record.dodgeModifier = def.dodgeModifier;
+        record.blocksMovement = def.blocksMovement ? 1 : 0;
+        record.blocksLineOfSight = def.blocksLineOfSight ? 1 : 0;
+        record.color[0] = def.color.r;
+        record.color[1] = def.color.g;
+        record.color[2] = def.color.b;
+        record.color[3] = def.color.a;
+        writer.terrain.push_back(record);
+    }
+
+    for (const AbilityDefinition* entry : sortedById(content.abilities)) {
+        const AbilityDefinition& def = *entry;
+        PackAbility record = {};
+        record.id = writer.addSymbol(def.id);
+        record.name = writer.addString(def.name);
+        record.description = writer.addString(def.description);
+        record.apCost = def.apCost;
+        record.energyCost = def.energyCost;
+        record.range = def.range;
+        record.targetType = static_cast<int32_t>(def.targetType);
+        record.effectType = static_cast<int32_t>(def.effectType);
+        record.power = def.power;
+        writer.abilities.push_back(record);
+    }
+
+    for (const ItemDefinition* entry : sortedById(content.items)) {
+        const ItemDefinition& def = *entry;
+        PackItem record = {};
+        record.id = writer.addSymbol(def.id);
+        record.name = writer.addString(def.name);
+        record.description = writer.addString(def.description);
+        writer.items.push_back(record);
+    }
+
+    for (const EntityDefinition* entry : sortedById(content.entities)) {
+        const EntityDefinition& def = *entry;
+        PackEntity record = {};
+        record.id = writer.addSymbol(def.id);
+        record.name = writer.addString(def.name);
+        record.dialog = writer.addString(def.dialog);
+        record.kind = static_cast<int32_t>(def.kind);
+        record.faction = static_cast<int32_t>(def.faction);
+        record.strength = def.attributes.strength;
+        record.agility = def.attributes.agility;
+        record.intelligence = def.attributes.intelligence;
+        record.defense = def.attributes.defense;
+        record.maxHP = def.maxHP;
+        record.maxEnergy = def.maxEnergy;
+        record.baseAttack = def.baseAttack;
+        record.attackRange = def.attackRange;
+        record.abilityIds = writer.addSymbolList(def.abilityIds);
+        record.passiveEffects = writer.addSymbolList(def.passiveEffects);
+        writer.entities.push_back(record);
+    }
+
+    for (Symbol mapId : content.maps->getOrder()) {
+        std::shared_ptr<const MapDefinition> built = content.maps->get(mapId);
+        if (!built) {
+            return false;
+        }
+        const MapDefinition& def = *built;
+        PackMap record = {};
+        record.id = writer.addSymbol(def.id);
+        record.name = writer.addString(def.name);
+        record.rhythm = writer.addString(def.rhythm);
+        record.width = def.width;
+        record.height = def.height;
+        record.mode = static_cast<int32_t>(def.mode);
+        record.turnLimit = def.turnLimit;
+
+        // Large maps built from a pack have no resident rows; copy them
+        // from that pack instead.
+        std::vector<std::vector<Symbol>> streamedRows;
+        if (def.terrainIds.empty() && static_cast<int64_t>(def.width) * def.height > 0) {
+            std::shared_ptr<const MapTerrainSource> terrain = content.maps->openTerrain(mapId);
+            std::vector<Symbol> row;
+            for (int y = 0; y < def.height; ++y) {
+                if (!terrain || !terrain->readTerrain(0, y, def.width, 1, row)) {
+                    return false;
+                }
+                streamedRows.push_back(row);
+            }
+        }
+        const auto& rows = streamedRows.empty() ? def.terrainIds : streamedRows;
+
+        std::vector<Symbol> palette;
+        SymbolMap<uint16_t> paletteIndex;
+        record.rows = {static_cast<uint32_t>(writer.lists.size()), static_cast<uint32_t>(rows.size())};
+        for (const auto& row : rows) {
+            writer.lists.push_back({static_cast<uint32_t>(writer.cells.size()), static_cast<uint32_t>(row.size())});
+            for (Symbol terrainId : row) {
+                auto it = paletteIndex.find(terrainId);
+                if (it == paletteIndex.end()) {
+                    if (palette.size() > 0xFFFF) {
+                        return false;
+                    }
+                    it = paletteIndex.emplace(terrainId, static_cast<uint16_t>(palette.size())).first;
+                    palette.push_back(terrainId);
+                }
+                writer.cells.push_back(it->second);
+            }
+        }
+        record.palette = writer.addSymbolList(palette);
+
+        record.specials = {static_cast<uint32_t>(writer.specials.size()), static_cast<uint32_t>(def.specials.size())};
+        for (const auto& special : def.specials) {
+            writer.specials.push_back({static_cast<int32_t>(special.type), special.x, special.y, special.value,
+                                       writer.addSymbol(special.targetId), special.targetX, special.targetY});
+        }
+        record.objectives = {static_cast<uint32_t>(writer.objectives.size()), static_cast<uint32_t>(def.objectives.size())};
+        for (const auto& objective : def.objectives) {
+            PackObjective packed = {};
+            packed.type = static_cast<int32_t>(objective.type);
+            packed.description = writer.addString(objective.description);
+            packed.targetId = writer.addSymbol(objective.targetId);
+            packed.amount = objective.amount;
+            packed.turnLimit = objective.turnLimit;
+            packed.targetX = objective.targetX;
+            packed.targetY = objective.targetY;
+            writer.objectives.push_back(packed);
+        }
+        record.loseConditions = writer.addStringList(def.loseConditions);
+        record.playerIds = writer.addSymbolList(def.playerIds);
+        record.enemyIds = writer.addSymbolList(def.enemyIds);
+        record.npcIds = writer.addSymbolList(def.npcIds);
+        record.playerSpawns = writer.addPoints(def.playerSpawns);
+        record.enemySpawns = writer.addPoints(def.enemySpawns);
+        record.npcSpawns = writer.addPoints(def.npcSpawns);
+        writer.maps.push_back(record);
+    }
+
+    for (const auto& digest : digests) {
+        writer.digests.push_back({static_cast<uint32_t>(digest.section), 0, digest.hash});
+    }
+
+    Header header = {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.sourceHash = stamp.hash;
+    header.sourceSize = stamp.size;
+    header.sourceModifiedTime = stamp.modifiedTime;
+
+    std::vector<char> body;
+    size_t offset = sizeof(Header);
+    auto place = [&](int section, const void* data, size_t count, size_t elementSize) {
+        size_t aligned = alignTo(offset, 8);
+        body.resize(aligned - sizeof(Header) + count * elementSize);
+        if (count > 0) {
+            std::memcpy(body.data() + (aligned - sizeof(Header)), data, count * elementSize);
+        }
+        header.sections[section] = {aligned, count};
+        offset = aligned + count * elementSize;
+    };
+    place(kStrings, writer.strings.data(), writer.strings.size(), 1);
+    place(kStringRefs, writer.stringRefs.data(), writer.stringRefs.size(), sizeof(PackString));
+    place(kLists, writer.lists.data(), writer.lists.size(), sizeof(PackList));
+    place(kTerrain, writer.terrain.data(), writer.terrain.size(), sizeof(PackTerrain));
+    place(kAbilities, writer.abilities.data(), writer.abilities.size(), sizeof(PackAbility));
+    place(kItems, writer.items.data(), writer.items.size(), sizeof(PackItem));
+    place(kEntities, writer.entities.data(), writer.entities.size(), sizeof(PackEntity));
+    place(kMaps, writer.maps.data(), writer.maps.size(), sizeof(PackMap));
+    place(kSpecials, writer.specials.data(), writer.specials.size(), sizeof(PackSpecial));
+    place(kObjectives, writer.objectives.data(), writer.objectives.size(), sizeof(PackObjective));
+    place(kPoints, writer.points.data(), writer.points.size(), sizeof(PackPoint));
+    place(kCells, writer.cells.data(), writer.cells.size(), sizeof(uint16_t));
+    place(kDigests, writer.digests.data(), writer.digests.size(), sizeof(PackDigest));
+
+    // Write to a temporary file and rename, so a running game that has the
+    // previous pack mapped never sees a half-written one.
+    const std::string tempPath = packPath + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        out.write(body.data(), static_cast<std::streamsize>(body.size()));
+        if (!out.good()) {
+            std::remove(tempPath.c_str());
+            return false;
+        }
+    }
+    if (std::rename(tempPath.c_str(), packPath.c_str()) != 0) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+ContentPack::ContentPack() : header(nullptr) {}
+
+bool ContentPack::open(const std::string& packPath) {
+    header = nullptr;
+    if (!file.open(packPath) || file.getSize() < sizeof(Header)) {
+        file.close();
+        return false;
+    }
+    const Header* candidate = reinterpret_cast<const Header*>(file.view().data());
+    if (std::memcmp(candidate->magic, kMagic, sizeof(kMagic)) != 0 || candidate->version != kVersion) {
+        file.close();
+        return false;
+    }
+    const size_t elementSizes[kSectionCount] = {
+        1, sizeof(PackString), sizeof(PackList), sizeof(PackTerrain), sizeof(PackAbility), sizeof(PackItem),
+        sizeof(PackEntity), sizeof(PackMap), sizeof(PackSpecial), sizeof(PackObjective), sizeof(PackPoint), sizeof(uint16_t),
+        sizeof(PackDigest)
+    };
+    for (int section = 0; section < kSectionCount; ++section) {
+        const PackSpan& span = candidate->sections[section];
+        if (span.offset % 8 != 0 || span.offset > file.getSize() ||
+            span.count > (file.getSize() - span.offset) / elementSizes[section]) {
+            file.close();
+            return false;
+        }
+    }
+    header = candidate;
+    return true;
+}
+
+bool ContentPack::matchesFileStat(const ContentSourceStamp& stamp) const {
+    return header && header->sourceSize == stamp.size && header->sourceModifiedTime == stamp.modifiedTime;
+}
+
+uint64_t ContentPack::getSourceHash() const {
+    return header ? header->sourceHash : 0;
+}
+
+bool ContentPack::updateStamp(const std::string& packPath, const ContentSourceStamp& stamp) {
+    int fd = ::open(packPath.c_str(), O_WRONLY);
+    if (fd < 0) {
+        return false;
+    }
+    const uint64_t size = stamp.size;
+    const int64_t modifiedTime = stamp.modifiedTime;
+    bool ok = pwrite(fd, &size, sizeof(size), offsetof(Header, sourceSize)) == sizeof(size) &&
+              pwrite(fd, &modifiedTime, sizeof(modifiedTime), offsetof(Header, sourceModifiedTime)) == sizeof(modifiedTime);
+    ::close(fd);
+    return ok;
+}
+
+template <typename T>
+const T* ContentPack::table(int section, uint64_t& count) const {
+    static_assert(std::is_trivially_copyable<T>::value, "pack records must be plain data");
+    count = header->sections[section].count;
+    return reinterpret_cast<const T*>(file.view().data() + header->sections[section].offset);
+}
+
+std::string_view ContentPack::stringAt(uint64_t offset, uint32_t length) const {
+    const PackSpan& span = header->sections[kStrings];
+    if (offset > span.count || length > span.count - offset) {
+        return std::string_view();
+    }
+    return file.view().substr(span.offset + offset, length);
+}
+
+struct ContentPack::Reader {
+    explicit Reader(const ContentPack& owner) : pack(owner) {
+        refs = pack.table<PackString>(kStringRefs, refCount);
+        lists = pack.table<PackList>(kLists, listCount);
+        specials = pack.table<PackSpecial>(kSpecials, specialCount);
+        objectives = pack.table<PackObjective>(kObjectives, objectiveCount);
+        points = pack.table<PackPoint>(kPoints, pointCount);
+        cells = pack.table<uint16_t>(kCells, cellCount);
+    }
+
+    static bool inRange(const PackList& list, uint64_t size) {
+        return list.first <= size && list.count <= size - list.first;
+    }
+
+    std::string text(const PackString& ref) const {
+        return std::string(pack.stringAt(ref.offset, ref.length));
+    }
+
+    Symbol symbol(const PackString& ref) const {
+        return internSymbol(pack.stringAt(ref.offset, ref.length));
+    }
+
+    bool textList(const PackList& list, std::vector<std::string>& out) const {
+        if (!inRange(list, refCount)) return false;
+        out.reserve(list.count);
+        for (uint32_t i = 0; i < list.count; ++i) {
+            out.push_back(text(refs[list.first + i]));
+        }
+        return true;
+    }
+
+    bool symbolList(const PackList& list, std::vector<Symbol>& out) const {
+        if (!inRange(list, refCount)) return false;
+        out.reserve(list.count);
+        for (uint32_t i = 0; i < list.count; ++i) {
+            out.push_back(symbol(refs[list.first + i]));
+        }
+        return true;
+    }
+
+    bool pointList(const PackList& list, std::vector<SDL_Point>& out) const {
+        if (!inRange(list, pointCount)) return false;
+        out.reserve(list.count);
+        for (uint32_t i = 0; i < list.count; ++i) {
+            out.push_back({points[list.first + i].x, points[list.first + i].y});
+        }
+        return true;
+    }
+
+    const ContentPack& pack;
+    uint64_t refCount = 0;
+    uint64_t listCount = 0;
+    uint64_t specialCount = 0;
+    uint64_t objectiveCount = 0;
+    uint64_t pointCount = 0;
+    uint64_t cellCount = 0;
+    const PackString* refs;
+    const PackList* lists;
+    const PackSpecial* specials;
+    const PackObjective* objectives;
+    const PackPoint* points;
+    const uint16_t* cells;
+};
+
+bool ContentPack::read(GameContent& content, MapCatalog& catalog) const {
+    if (!header) {
+        return false;
+    }
+    Reader reader(*this);
+
+    uint64_t count = 0;
+    const PackTerrain* terrain = table<PackTerrain>(kTerrain, count);
+    for (uint64_t i = 0; i < count; ++i) {
+        TerrainTypeDefinition def;
+        def.id = reader.symbol(terrain[i].id);
+        def.name = reader.text(terrain[i].name);
+        def.movementCost = terrain[i].movementCost;
+        def.defenseModifier = terrain[i].defenseModifier;
+        def.dodgeModifier = terrain[i].dodgeModifier;
+        def.blocksMovement = terrain[i].blocksMovement != 0;
+        def.blocksLineOfSight = terrain[i].blocksLineOfSight != 0;
+        def.color = {terrain[i].color[0], terrain[i].color[1], terrain[i].color[2], terrain[i].color[3]};
+        content.terrainTypes[def.id] = std::move(def);
+    }
+
+    const PackAbility* abilities = table<PackAbility>(kAbilities, count);
+    for (uint64_t i = 0; i < count; ++i) {
+        AbilityDefinition def;
+        def.id = reader.symbol(abilities[i].id);
+        def.name = reader.text(abilities[i].name);
+        def.description = reader.text(abilities[i].description);
+        def.apCost = abilities[i].apCost;
+        def.energyCost = abilities[i].energyCost;
+        def.range = abilities[i].range;
+        def.targetType = static_cast<AbilityTargetType>(abilities[i].targetType);
+        def.effectType = static_cast<AbilityEffectType>(abilities[i].effectType);
+        def.power = abilities[i].power;
+        resolveAbilityStatus(def);
+        content.abilities[def.id] = std::move(def);
+    }
+
+    const PackItem* items = table<PackItem>(kItems, count);
+    for (uint64_t i = 0; i < count; ++i) {
+        ItemDefinition def;
+        def.id = reader.symbol(items[i].id);
+        def.name = reader.text(items[i].name);
+        def.description = reader.text(items[i].description);
+        content.items[def.id] = std::move(def);
+    }
+
+    const PackEntity* entities = table<PackEntity>(kEntities, count);
+    for (uint64_t i = 0; i < count; ++i) {
+        const PackEntity& record = entities[i];
+        EntityDefinition def;
+        def.id = reader.symbol(record.id);
+        def.name = reader.text(record.name);
+        def.dialog = reader.text(record.dialog);
+        def.kind = static_cast<EntityKind>(record.kind);
+        def.faction = static_cast<EntityFaction>(record.faction);
+        def.attributes.strength = record.strength;
+        def.attributes.agility = record.agility;
+        def.attributes.intelligence = record.intelligence;
+        def.attributes.defense = record.defense;
+        def.maxHP = record.maxHP;
+        def.maxEnergy = record.maxEnergy;
+        def.baseAttack = record.baseAttack;
+        def.attackRange = record.attackRange;
+        if (!reader.symbolList(record.abilityIds, def.abilityIds) || !reader.symbolList(record.passiveEffects, def.passiveEffects)) {
+            return false;
+        }
+        content.entities[def.id] = std::move(def);
+    }
+
+    const PackMap* maps = table<PackMap>(kMaps, count);
+    for (uint64_t i = 0; i < count; ++i) {
+        const PackMap& record = maps[i];
+        if (!Reader::inRange(record.rows, reader.listCount) ||
+            !Reader::inRange(record.specials, reader.specialCount) ||
+            !Reader::inRange(record.objectives, reader.objectiveCount)) {
+            return false;
+        }
+        catalog.add(reader.symbol(record.id), static_cast<size_t>(i));
+    }
+    return true;
+}
+
+bool ContentPack::buildMap(size_t recordIndex, MapDefinition& def) const {
+    if (!header) {
+        return false;
+    }
+    uint64_t count = 0;
+    const PackMap* maps = table<PackMap>(kMaps, count);
+    if (recordIndex >= count) {
+        return false;
+    }
+    Reader reader(*this);
+    const PackMap& record = maps[recordIndex];
+    def.id = reader.symbol(record.id);
+    def.name = reader.text(record.name);
+    def.rhythm = reader.text(record.rhythm);
+    def.width = record.width;
+    def.height = record.height;
+    def.mode = static_cast<GameModeType>(record.mode);
+    def.turnLimit = record.turnLimit;
+
+    std::vector<Symbol> palette;
+    if (!reader.symbolList(record.palette, palette) || !Reader::inRange(record.rows, reader.listCount)) {
+        return false;
+    }
+    const bool residentTerrain = static_cast<int64_t>(record.width) * record.height <= kResidentTerrainCells;
+    def.terrainIds.resize(residentTerrain ? record.rows.count : 0);
+    for (uint32_t y = 0; y < record.rows.count; ++y) {
+        const PackList& row = reader.lists[record.rows.first + y];
+        if (!Reader::inRange(row, reader.cellCount)) {
+            return false;
+        }
+        if (!residentTerrain) continue;
+        std::vector<Symbol>& rowIds = def.terrainIds[y];
+        rowIds.reserve(row.count);
+        for (uint32_t x = 0; x < row.count; ++x) {
+            uint16_t index = reader.cells[row.first + x];
+            if (index >= palette.size()) {
+                return false;
+            }
+            rowIds.push_back(palette[index]);
+        }
+    }
+
+    if (!Reader::inRange(record.specials, reader.specialCount) || !Reader::inRange(record.objectives, reader.objectiveCount)) {
+        return false;
+    }
+    for (uint32_t s = 0; s < record.specials.count; ++s) {
+        const PackSpecial& packed = reader.specials[record.specials.first + s];
+        SpecialTileDefinition special;
+        special.type = static_cast<TileSpecialType>(packed.type);
+        special.x = packed.x;
+        special.y = packed.y;
+        special.value = packed.value;
+        special.targetId = reader.symbol(packed.targetId);
+        special.targetX = packed.targetX;
+        special.targetY = packed.targetY;
+        def.specials.push_back(special);
+    }
+    for (uint32_t o = 0; o < record.objectives.count; ++o) {
+        const PackObjective& packed = reader.objectives[record.objectives.first + o];
+        MissionObjectiveDefinition objective;
+        objective.type = static_cast<ObjectiveType>(packed.type);
+        objective.description = reader.text(packed.description);
+        objective.targetId = reader.symbol(packed.targetId);
+        objective.amount = packed.amount;
+        objective.turnLimit = packed.turnLimit;
+        objective.targetX = packed.targetX;
+        objective.targetY = packed.targetY;
+        def.objectives.push_back(objective);
+    }
+    if (!reader.textList(record.loseConditions, def.loseConditions) ||
+        !reader.symbolList(record.playerIds, def.playerIds) ||
+        !reader.symbolList(record.enemyIds, def.enemyIds) ||
+        !reader.symbolList(record.npcIds, def.npcIds) ||
+        !reader.pointList(record.playerSpawns, def.playerSpawns) ||
+        !reader.pointList(record.enemySpawns, def.enemySpawns) ||
+        !reader.pointList(record.npcSpawns, def.npcSpawns)) {
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<const MapTerrainSource> ContentPack::openTerrain(size_t recordIndex) const {
+    return std::make_shared<PackTerrainSource>(shared_from_this(), recordIndex);
+}
+
+bool ContentPack::readTerrain(size_t recordIndex, int x, int y, int width, int height, std::vector<Symbol>& ids) const {
+    ids.assign(static_cast<size_t>(width) * height, Symbol());
+    if (!header) {
+        return false;
+    }
+    uint64_t count = 0;
+    const PackMap* maps = table<PackMap>(kMaps, count);
+    if (recordIndex >= count) {
+        return false;
+    }
+    Reader reader(*this);
+    const PackMap& record = maps[recordIndex];
+    if (!Reader::inRange(record.palette, reader.refCount) || !Reader::inRange(record.rows, reader.listCount)) {
+        return false;
+    }
+    // Only the palette entries this rectangle uses get interned.
+    std::vector<Symbol> palette(record.palette.count);
+    std::vector<char> resolved(record.palette.count, 0);
+    for (int row = 0; row < height; ++row) {
+        if (y + row < 0 || static_cast<uint32_t>(y + row) >= record.rows.count) continue;
+        const PackList& cells = reader.lists[record.rows.first + y + row];
+        if (!Reader::inRange(cells, reader.cellCount)) {
+            return false;
+        }
+        for (int column = 0; column < width; ++column) {
+            if (x + column < 0 || static_cast<uint32_t>(x + column) >= cells.count) continue;
+            uint16_t index = reader.cells[cells.first + x + column];
+            if (index >= palette.size()) {
+                return false;
+            }
+            if (!resolved[index]) {
+                palette[index] = reader.symbol(reader.refs[record.palette.first + index]);
+                resolved[index] = 1;
+            }
+            ids[static_cast<size_t>(row) * width + column] = palette[index];
+        }
+    }
+    return true;
+}
+
+bool ContentPack::readDigests(std::vector<ContentRecordDigest>& digests) const {
+    if (!header) {
+        return false;
+    }
+    uint64_t count = 0;
+    const PackDigest* packed = table<PackDigest>(kDigests, count);
+    digests.clear();
+    digests.reserve(count);
+    for (uint64_t i = 0; i < count; ++i) {
+        digests.push_back({static_cast<ContentSection>(packed[i].section), packed[i].hash});
+    }
+    return true;
+}
@@ -0,0 +1,65 @@
+#ifndef CONTENTPACK_H
+#define CONTENTPACK_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "GameContent.h"
+#include "MapCatalog.h"
+#include "MappedFile.h"
+
+struct ContentSourceStamp {
+    uint64_t hash = 0;
+    uint64_t size = 0;
+    int64_t modifiedTime = 0;
+};
+
+// Versioned binary snapshot of GameContent (.edpak): flat record tables
+// that reference a shared string table by offset. Opened through mmap and
+// read without any text parsing. Map records are only indexed by read();
+// the pack serves as their MapSource, so it must stay open while they can
+// still be built. Maps larger than kResidentTerrainCells are built without
+// their rows; their terrain is read in pieces through openTerrain. Packs
+// must be owned by a shared_ptr.
+class ContentPack : public MapSource, public std::enable_shared_from_this<ContentPack> {
+public:
+    static const uint32_t kVersion = 3;
+    static const int64_t kResidentTerrainCells = 256 * 256;
+
+    static std::string pathFor(const std::string& sourcePath);
+    static bool statSource(const std::string& sourcePath, ContentSourceStamp& stamp);
+    static uint64_t hashBytes(std::string_view bytes);
+    static bool write(const std::string& packPath, const GameContent& content, const ContentSourceStamp& stamp,
+                      const std::vector<ContentRecordDigest>& digests);
+
+    ContentPack();
+
+    bool open(const std::string& packPath);
+    bool isOpen() const { return header != nullptr; }
+    bool matchesFileStat(const ContentSourceStamp& stamp) const;
+    uint64_t getSourceHash() const;
+    // Records a new size/mtime for a source whose content hash is unchanged.
+    bool updateStamp(const std::string& packPath, const ContentSourceStamp& stamp);
+    // Map records are indexed into `catalog` rather than content.maps.
+    bool read(GameContent& content, MapCatalog& catalog) const;
+    bool buildMap(size_t recordIndex, MapDefinition& definition) const override;
+    std::shared_ptr<const MapTerrainSource> openTerrain(size_t recordIndex) const override;
+    bool readTerrain(size_t recordIndex, int x, int y, int width, int height, std::vector<Symbol>& ids) const;
+    // Per-record hashes of the source JSON, for incremental reloads.
+    bool readDigests(std::vector<ContentRecordDigest>& digests) const;
+
+private:
+    struct Header;
+    struct Reader;
+
+    MappedFile file;
+    const Header* header;
+
+    template <typename T>
+    const T* table(int section, uint64_t& count) const;
+    std::string_view stringAt(uint64_t offset, uint32_t length) const;
+};
+
+#endif
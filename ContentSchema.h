@@ -0,0 +1,113 @@
+#ifndef CONTENTSCHEMA_H
+#define CONTENTSCHEMA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include "SimpleJson.h"
+
+// One JSON key of a content struct. `bind` is also called with a null value
+// when the key is missing, so each binding owns its default.
+template <typename T>
+struct FieldBinding {
+    std::string_view key;
+    void (*bind)(T& target, const SimpleJsonValue& value) = nullptr;
+};
+
+// Binds JSON objects to T through a fixed field table. Keys are matched by
+// a perfect hash found at compile time, so an object's members are walked
+// once with one hash and one compare each. Bindings then run in table
+// order, which lets a field depend on fields listed before it. When a key
+// repeats, the last value wins.
+template <typename T, size_t N>
+class ContentSchema {
+public:
+    constexpr explicit ContentSchema(const FieldBinding<T> (&table)[N]) : fields(), slots(), seed(0) {
+        static_assert(N > 0 && N < kEmpty, "schema needs between 1 and 254 fields");
+        for (size_t i = 0; i < N; ++i) {
+            fields[i] = table[i];
+        }
+        seed = findSeed();
+        for (size_t i = 0; i < kSlotCount; ++i) {
+            slots[i] = kEmpty;
+        }
+        for (size_t i = 0; i < N; ++i) {
+            slots[slotOf(fields[i].key, seed)] = static_cast<uint8_t>(i);
+        }
+    }
+
+    void bind(T& target, const SimpleJsonValue& object) const {
+        static const SimpleJsonValue missing;
+        const SimpleJsonValue* values[N];
+        for (size_t i = 0; i < N; ++i) {
+            values[i] = &missing;
+        }
+        if (object.getType() == SimpleJsonValue::Type::Object) {
+            for (const auto& member : object.asObject()) {
+                uint8_t index = slots[slotOf(member.key, seed)];
+                if (index != kEmpty && fields[index].key == member.key) {
+                    values[index] = &member.value;
+                }
+            }
+        }
+        for (size_t i = 0; i < N; ++i) {
+            fields[i].bind(target, *values[i]);
+        }
+    }
+
+    T read(const SimpleJsonValue& object) const {
+        T target;
+        bind(target, object);
+        return target;
+    }
+
+private:
+    static constexpr uint8_t kEmpty = 0xFF;
+    static constexpr unsigned slotBits() {
+        unsigned bits = 1;
+        while ((size_t(1) << bits) < N * 2) {
+            bits++;
+        }
+        return bits;
+    }
+    static constexpr unsigned kSlotBits = slotBits();
+    static constexpr size_t kSlotCount = size_t(1) << kSlotBits;
+
+    FieldBinding<T> fields[N];
+    uint8_t slots[kSlotCount];
+    uint32_t seed;
+
+    static constexpr size_t slotOf(std::string_view key, uint32_t seed) {
+        uint32_t hash = 2166136261u ^ seed;
+        for (char c : key) {
+            hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+        }
+        hash ^= hash >> 15;
+        hash *= 0x2C1B3C6Du;
+        return hash >> (32 - kSlotBits);
+    }
+
+    constexpr uint32_t findSeed() const {
+        for (uint32_t candidate = 0; candidate < 1u << 16; ++candidate) {
+            bool used[kSlotCount] = {};
+            bool collides = false;
+            for (size_t i = 0; i < N && !collides; ++i) {
+                size_t slot = slotOf(fields[i].key, candidate);
+                collides = used[slot];
+                used[slot] = true;
+            }
+            if (!collides) {
+                return candidate;
+            }
+        }
+        throw std::logic_error("no perfect hash for schema keys");
+    }
+};
+
+template <typename T, size_t N>
+constexpr ContentSchema<T, N> makeSchema(const FieldBinding<T> (&table)[N]) {
+    return ContentSchema<T, N>(table);
+}
+
+#endif
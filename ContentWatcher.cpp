@@ -0,0 +1,57 @@
+#include "ContentWatcher.h"
+#include <sys/inotify.h>
+#include <unistd.h>
+
+ContentWatcher::ContentWatcher() : fd(-1), watchDescriptor(-1) {}
+
+ContentWatcher::~ContentWatcher() {
+    stop();
+}
+
+bool ContentWatcher::watch(const std::string& path) {
+    stop();
+    size_t slash = path.find_last_of('/');
+    std::string directory = slash == std::string::npos ? "." : path.substr(0, slash == 0 ? 1 : slash);
+    fileName = slash == std::string::npos ? path : path.substr(slash + 1);
+
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    watchDescriptor = inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (watchDescriptor < 0) {
+        stop();
+        return false;
+    }
+    return true;
+}
+
+void ContentWatcher::stop() {
+    if (fd >= 0) {
+        ::close(fd);
+    }
+    fd = -1;
+    watchDescriptor = -1;
+}
+
+bool ContentWatcher::poll() {
+    if (fd < 0) {
+        return false;
+    }
+    bool changed = false;
+    alignas(struct inotify_event) char buffer[4096];
+    while (true) {
+        ssize_t length = read(fd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            break;
+        }
+        for (char* cursor = buffer; cursor < buffer + length;) {
+            const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(cursor);
+            if (event->wd == watchDescriptor && event->len > 0 && fileName == event->name) {
+                changed = true;
+            }
+            cursor += sizeof(struct inotify_event) + event->len;
+        }
+    }
+    return changed;
+}
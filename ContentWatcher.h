@@ -0,0 +1,29 @@
+#ifndef CONTENTWATCHER_H
+#define CONTENTWATCHER_H
+
+#include <string>
+
+// Watches one file through inotify on its directory, so both in-place
+// writes and editors that save through a rename are noticed.
+class ContentWatcher {
+public:
+    ContentWatcher();
+    ~ContentWatcher();
+
+    ContentWatcher(const ContentWatcher&) = delete;
+    ContentWatcher& operator=(const ContentWatcher&) = delete;
+
+    bool watch(const std::string& path);
+    void stop();
+    bool isWatching() const { return fd >= 0; }
+    // Non-blocking. True if the file was written or replaced since the
+    // previous call; bursts of events collapse into one change.
+    bool poll();
+
+private:
+    int fd;
+    int watchDescriptor;
+    std::string fileName;
+};
+
+#endif
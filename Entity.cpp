@@ -1,34 +1,92 @@
 #include "Entity.h"
+#include "OccupancyGrid.h"
 #include <algorithm>
 
+namespace {
+// Growth per level above the first.
+const int kAttributesPerLevel = 1;
+const int kHPPerLevel = 10;
+const int kEnergyPerLevel = 5;
+}
+
 Entity::Entity(const EntityDefinition& definition, const SDL_Point& spawn)
-    : id(definition.id),
-      name(definition.name),
-      kind(definition.kind),
-      faction(definition.faction),
-      attributes(definition.attributes),
+    : definition(&definition),
       level(1),
       experience(0),
       experienceToNext(100),
-      maxHP(definition.maxHP),
       currentHP(definition.maxHP),
-      maxEnergy(definition.maxEnergy),
       currentEnergy(definition.maxEnergy),
       actionPoints(0),
-      baseAttack(definition.baseAttack),
-      attackRange(definition.attackRange),
-      abilityIds(definition.abilityIds),
-      passiveEffects(definition.passiveEffects),
-      position(spawn) {
+      position(spawn),
+      occupancyGrid(nullptr) {
 }
 
 void Entity::update() {
     tickStatuses();
 }
 
+void Entity::rebindDefinition(const EntityDefinition& updated) {
+    // The faction may change with the definition.
+    const bool tracked = occupancyGrid && isAlive();
+    if (tracked) {
+        occupancyGrid->remove(*this);
+    }
+    definition = &updated;
+    if (currentHP > 0) {
+        currentHP = std::min(std::max(1, currentHP), getMaxHP());
+    }
+    currentEnergy = std::min(currentEnergy, getMaxEnergy());
+    if (tracked) {
+        occupancyGrid->add(*this);
+    }
+}
+
+int Entity::getMaxHP() const {
+    return std::max(1, definition->maxHP + (level - 1) * kHPPerLevel);
+}
+
+int Entity::getMaxEnergy() const {
+    return std::max(0, definition->maxEnergy + (level - 1) * kEnergyPerLevel);
+}
+
+Attributes Entity::getAttributes() const {
+    Attributes attributes = definition->attributes;
+    int bonus = (level - 1) * kAttributesPerLevel;
+    attributes.strength += bonus;
+    attributes.agility += bonus;
+    attributes.intelligence += bonus;
+    attributes.defense += bonus;
+    return attributes;
+}
+
 void Entity::setPosition(int x, int y) {
+    const SDL_Point from = position;
     position.x = x;
     position.y = y;
+    if (occupancyGrid && isAlive()) {
+        occupancyGrid->move(*this, from);
+    }
+}
+
+void Entity::setOccupancyGrid(OccupancyGrid* grid) {
+    if (occupancyGrid && isAlive()) {
+        occupancyGrid->remove(*this);
+    }
+    occupancyGrid = grid;
+    if (occupancyGrid && isAlive()) {
+        occupancyGrid->add(*this);
+    }
+}
+
+void Entity::syncOccupancy(bool wasAlive) {
+    if (!occupancyGrid || wasAlive == isAlive()) {
+        return;
+    }
+    if (isAlive()) {
+        occupancyGrid->add(*this);
+    } else {
+        occupancyGrid->remove(*this);
+    }
 }
 
 void Entity::consumeActionPoints(int value) {
@@ -44,11 +102,15 @@ void Entity::grantExperience(int amount) {
 }
 
 void Entity::takeDamage(int amount) {
+    const bool wasAlive = isAlive();
     currentHP = std::max(0, currentHP - amount);
+    syncOccupancy(wasAlive);
 }
 
 void Entity::heal(int amount) {
-    currentHP = std::min(maxHP, currentHP + amount);
+    const bool wasAlive = isAlive();
+    currentHP = std::min(getMaxHP(), currentHP + amount);
+    syncOccupancy(wasAlive);
 }
 
 void Entity::spendEnergy(int amount) {
@@ -56,10 +118,10 @@ void Entity::spendEnergy(int amount) {
 }
 
 void Entity::restoreEnergy(int amount) {
-    currentEnergy = std::min(maxEnergy, currentEnergy + amount);
+    currentEnergy = std::min(getMaxEnergy(), currentEnergy + amount);
 }
 
-void Entity::addStatus(const std::string& statusId, int duration) {
+void Entity::addStatus(Symbol statusId, int duration) {
     statuses.push_back({statusId, duration});
 }
 
@@ -74,16 +136,12 @@ void Entity::tickStatuses() {
 }
 
 void Entity::levelUp() {
+    const bool wasAlive = isAlive();
     level++;
     experienceToNext += level * 50;
-    attributes.strength += 1;
-    attributes.agility += 1;
-    attributes.intelligence += 1;
-    attributes.defense += 1;
-    maxHP += 10;
-    maxEnergy += 5;
-    currentHP = maxHP;
-    currentEnergy = maxEnergy;
+    currentHP = getMaxHP();
+    syncOccupancy(wasAlive);
+    currentEnergy = getMaxEnergy();
 }
 
 PlayerEntity::PlayerEntity(const EntityDefinition& definition, const SDL_Point& spawn)
@@ -95,6 +153,10 @@ EnemyEntity::EnemyEntity(const EntityDefinition& definition, const SDL_Point& sp
 }
 
 NpcEntity::NpcEntity(const EntityDefinition& definition, const SDL_Point& spawn)
-    : Entity(definition, spawn),
-      dialog(definition.dialog.empty() ? "..." : definition.dialog) {
+    : Entity(definition, spawn) {
+}
+
+const std::string& NpcEntity::getDialog() const {
+    static const std::string silent = "...";
+    return definition->dialog.empty() ? silent : definition->dialog;
 }
@@ -6,37 +6,48 @@
 #include <SDL2/SDL.h>
 #include "GameContent.h"
 
+class OccupancyGrid;
+
 struct StatusEffectState {
-    std::string id;
+    Symbol id;
     int remainingTurns = 0;
 };
 
+// Runtime state of one unit. Everything fixed by content is read through
+// `definition`, which points into a shared content snapshot and must outlive
+// the entity.
 class Entity {
 public:
     Entity(const EntityDefinition& definition, const SDL_Point& spawn);
     virtual ~Entity() = default;
 
     virtual void update();
-
-    const std::string& getId() const { return id; }
-    const std::string& getName() const { return name; }
-    EntityKind getKind() const { return kind; }
-    EntityFaction getFaction() const { return faction; }
+    // Points the entity at a newer version of its definition. Level-up gains
+    // and damage taken are kept.
+    void rebindDefinition(const EntityDefinition& updated);
+
+    const EntityDefinition& getDefinition() const { return *definition; }
+    Symbol getId() const { return definition->id; }
+    const std::string& getName() const { return definition->name; }
+    EntityKind getKind() const { return definition->kind; }
+    EntityFaction getFaction() const { return definition->faction; }
     SDL_Point getPosition() const { return position; }
     void setPosition(int x, int y);
+    // From then on the grid follows this unit's moves, death and revival.
+    void setOccupancyGrid(OccupancyGrid* grid);
 
     int getCurrentHP() const { return currentHP; }
-    int getMaxHP() const { return maxHP; }
+    int getMaxHP() const;
     int getCurrentEnergy() const { return currentEnergy; }
-    int getMaxEnergy() const { return maxEnergy; }
+    int getMaxEnergy() const;
     int getActionPoints() const { return actionPoints; }
     void setActionPoints(int value) { actionPoints = value; }
     void consumeActionPoints(int value);
     bool hasActionPoints(int value) const { return actionPoints >= value; }
 
-    int getBaseAttack() const { return baseAttack; }
-    int getAttackRange() const { return attackRange; }
-    const Attributes& getAttributes() const { return attributes; }
+    int getBaseAttack() const { return definition->baseAttack; }
+    int getAttackRange() const { return definition->attackRange; }
+    Attributes getAttributes() const;
 
     int getLevel() const { return level; }
     int getExperience() const { return experience; }
@@ -50,35 +61,27 @@ public:
     bool hasEnergy(int amount) const { return currentEnergy >= amount; }
     void restoreEnergy(int amount);
 
-    void addStatus(const std::string& statusId, int duration);
+    void addStatus(Symbol statusId, int duration);
     void tickStatuses();
     const std::vector<StatusEffectState>& getStatuses() const { return statuses; }
 
-    const std::vector<std::string>& getAbilityIds() const { return abilityIds; }
-    const std::vector<std::string>& getPassiveEffects() const { return passiveEffects; }
+    const std::vector<Symbol>& getAbilityIds() const { return definition->abilityIds; }
+    const std::vector<Symbol>& getPassiveEffects() const { return definition->passiveEffects; }
 
 protected:
-    std::string id;
-    std::string name;
-    EntityKind kind;
-    EntityFaction faction;
-    Attributes attributes;
+    const EntityDefinition* definition;
     int level;
     int experience;
     int experienceToNext;
-    int maxHP;
     int currentHP;
-    int maxEnergy;
     int currentEnergy;
     int actionPoints;
-    int baseAttack;
-    int attackRange;
-    std::vector<std::string> abilityIds;
-    std::vector<std::string> passiveEffects;
     SDL_Point position;
     std::vector<StatusEffectState> statuses;
+    OccupancyGrid* occupancyGrid;
 
     void levelUp();
+    void syncOccupancy(bool wasAlive);
 };
 
 class PlayerEntity : public Entity {
@@ -94,9 +97,7 @@ public:
 class NpcEntity : public Entity {
 public:
     NpcEntity(const EntityDefinition& definition, const SDL_Point& spawn);
-    const std::string& getDialog() const { return dialog; }
-private:
-    std::string dialog;
+    const std::string& getDialog() const;
 };
 
 #endif
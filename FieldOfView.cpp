@@ -0,0 +1,198 @@
+#include "FieldOfView.h"
+#include "Map.h"
+#include <algorithm>
+
+namespace {
+// Slopes are (2 * col - 1) / (2 * depth) and friends, kept as fractions so
+// the symmetry test is exact.
+struct Row {
+    int depth;
+    int startNum;
+    int startDen;
+    int endNum;
+    int endDen;
+};
+
+int floorDiv(int num, int den) {
+    int quotient = num / den;
+    return (num % den != 0 && (num < 0) != (den < 0)) ? quotient - 1 : quotient;
+}
+
+int roundTiesUp(int num, int den) {
+    return floorDiv(2 * num + den, 2 * den);
+}
+
+int roundTiesDown(int num, int den) {
+    return -floorDiv(-(2 * num - den), 2 * den);
+}
+
+SDL_Point transform(int quadrant, const SDL_Point& origin, int depth, int col) {
+    switch (quadrant) {
+    case 0: return {origin.x + col, origin.y - depth};
+    case 1: return {origin.x + depth, origin.y + col};
+    case 2: return {origin.x + col, origin.y + depth};
+    default: return {origin.x - depth, origin.y + col};
+    }
+}
+}
+
+FieldOfView::FieldOfView() : map(nullptr), width(0), height(0) {}
+
+void FieldOfView::reset(const Map& source) {
+    map = &source;
+    width = source.getWidth();
+    height = source.getHeight();
+    units.clear();
+    for (auto& faction : factions) {
+        faction.viewers.clear();
+        faction.explored.clear();
+    }
+}
+
+void FieldOfView::invalidate() {
+    for (auto& item : units) {
+        clear(item.second);
+    }
+}
+
+void FieldOfView::updateViewer(const Entity& entity, int radius) {
+    if (!map) {
+        return;
+    }
+    Viewer& viewer = units[&entity];
+    const SDL_Point origin = entity.getPosition();
+    const int faction = static_cast<int>(entity.getFaction());
+    if (!entity.isAlive() || !map->isInside(origin.x, origin.y)) {
+        clear(viewer);
+        return;
+    }
+    if (viewer.radius == radius && viewer.faction == faction &&
+        viewer.origin.x == origin.x && viewer.origin.y == origin.y) {
+        return;
+    }
+    clear(viewer);
+    viewer.origin = origin;
+    viewer.radius = radius;
+    viewer.faction = faction;
+    cast(viewer);
+    apply(viewer, true);
+}
+
+void FieldOfView::removeViewer(const Entity& entity) {
+    auto it = units.find(&entity);
+    if (it != units.end()) {
+        clear(it->second);
+        units.erase(it);
+    }
+}
+
+bool FieldOfView::canSee(const Entity& entity, int x, int y) const {
+    auto it = units.find(&entity);
+    return it != units.end() && it->second.seen.test(x, y);
+}
+
+void FieldOfView::restrictToVisible(const Entity& entity, BitBoard& board) const {
+    auto it = units.find(&entity);
+    if (it == units.end()) {
+        board.clearAll();
+    } else {
+        board &= it->second.seen;
+    }
+}
+
+bool FieldOfView::isVisible(EntityFaction faction, int x, int y) const {
+    const FactionView& view = factions[static_cast<int>(faction)];
+    if (view.viewers.empty() || x < 0 || y < 0 || x >= width || y >= height) {
+        return false;
+    }
+    return view.viewers[static_cast<size_t>(y) * width + x] > 0;
+}
+
+bool FieldOfView::isExplored(EntityFaction faction, int x, int y) const {
+    const FactionView& view = factions[static_cast<int>(faction)];
+    if (view.explored.empty() || x < 0 || y < 0 || x >= width || y >= height) {
+        return false;
+    }
+    const size_t index = static_cast<size_t>(y) * width + x;
+    return (view.explored[index >> 6] >> (index & 63)) & 1;
+}
+
+// Albert Ford's symmetric shadowcasting, one quadrant at a time, with rows
+// kept on a stack instead of recursing. Tiles off the map count as walls.
+void FieldOfView::cast(Viewer& viewer) const {
+    const int radius = viewer.radius;
+    const SDL_Point origin = viewer.origin;
+    const int left = std::max(0, origin.x - radius);
+    const int top = std::max(0, origin.y - radius);
+    viewer.seen.reset({left, top, std::min(width, origin.x + radius + 1) - left,
+                       std::min(height, origin.y + radius + 1) - top});
+    viewer.seen.set(origin.x, origin.y);
+
+    const int radiusLimit = radius * radius + radius;
+    std::vector<Row> rows;
+    for (int quadrant = 0; quadrant < 4; ++quadrant) {
+        rows.push_back({1, -1, 1, 1, 1});
+        while (!rows.empty()) {
+            Row row = rows.back();
+            rows.pop_back();
+            if (row.depth > radius) {
+                continue;
+            }
+            const int minCol = roundTiesUp(row.depth * row.startNum, row.startDen);
+            const int maxCol = roundTiesDown(row.depth * row.endNum, row.endDen);
+            int previous = 0; // 0 none, 1 wall, 2 floor
+            for (int col = minCol; col <= maxCol; ++col) {
+                const SDL_Point tile = transform(quadrant, origin, row.depth, col);
+                const bool inside = map->isInside(tile.x, tile.y);
+                const bool wall = !inside || map->blocksLineOfSight(tile.x, tile.y);
+                const bool symmetric = col * row.startDen >= row.depth * row.startNum &&
+                                       col * row.endDen <= row.depth * row.endNum;
+                if (inside && (wall || symmetric) && col * col + row.depth * row.depth <= radiusLimit) {
+                    viewer.seen.set(tile.x, tile.y);
+                }
+                if (previous == 1 && !wall) {
+                    row.startNum = 2 * col - 1;
+                    row.startDen = 2 * row.depth;
+                }
+                if (previous == 2 && wall) {
+                    rows.push_back({row.depth + 1, row.startNum, row.startDen, 2 * col - 1, 2 * row.depth});
+                }
+                previous = wall ? 1 : 2;
+            }
+            if (previous == 2) {
+                rows.push_back({row.depth + 1, row.startNum, row.startDen, row.endNum, row.endDen});
+            }
+        }
+    }
+}
+
+void FieldOfView::apply(const Viewer& viewer, bool add) {
+    FactionView& view = factionView(viewer.faction);
+    viewer.seen.forEach([&](int x, int y) {
+        const size_t index = static_cast<size_t>(y) * width + x;
+        if (add) {
+            view.viewers[index]++;
+            view.explored[index >> 6] |= uint64_t(1) << (index & 63);
+        } else {
+            view.viewers[index]--;
+        }
+    });
+}
+
+void FieldOfView::clear(Viewer& viewer) {
+    if (viewer.radius >= 0) {
+        apply(viewer, false);
+    }
+    viewer.radius = -1;
+    viewer.seen.reset({0, 0, 0, 0});
+}
+
+FieldOfView::FactionView& FieldOfView::factionView(int faction) {
+    FactionView& view = factions[faction];
+    if (view.viewers.empty()) {
+        const size_t tileCount = static_cast<size_t>(width) * height;
+        view.viewers.assign(tileCount, 0);
+        view.explored.assign((tileCount + 63) / 64, 0);
+    }
+    return view;
+}
@@ -0,0 +1,64 @@
+#ifndef FIELDOFVIEW_H
+#define FIELDOFVIEW_H
+
+#include <SDL2/SDL.h>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "BitBoard.h"
+#include "Entity.h"
+
+class Map;
+
+// Per-unit and per-faction visibility from symmetric shadowcasting: a floor
+// tile A sees floor tile B exactly when B sees A. Each unit keeps the tiles
+// it sees inside its sight square, and each faction keeps a count of units
+// seeing every tile plus the tiles it has ever seen. Only units that moved,
+// died or changed sight radius are recast, so all queries are table reads.
+class FieldOfView {
+public:
+    FieldOfView();
+
+    // Drops every unit and faction record; call when a map is loaded.
+    void reset(const Map& map);
+    // Recasts every unit on the next update, e.g. after terrain changed.
+    void invalidate();
+    // Recasts the unit if it moved or changed radius since the last call.
+    // Dead units stop seeing anything.
+    void updateViewer(const Entity& entity, int radius);
+    void removeViewer(const Entity& entity);
+
+    bool canSee(const Entity& entity, int x, int y) const;
+    // Clears the tiles of `board` the unit cannot see.
+    void restrictToVisible(const Entity& entity, BitBoard& board) const;
+    bool isVisible(EntityFaction faction, int x, int y) const;
+    bool isExplored(EntityFaction faction, int x, int y) const;
+
+private:
+    struct Viewer {
+        SDL_Point origin = {0, 0};
+        int radius = -1;
+        int faction = 0;
+        // Covers the sight square, clipped to the map.
+        BitBoard seen;
+    };
+
+    struct FactionView {
+        std::vector<uint16_t> viewers;
+        std::vector<uint64_t> explored;
+    };
+
+    const Map* map;
+    int width;
+    int height;
+    std::unordered_map<const Entity*, Viewer> units;
+    FactionView factions[kFactionCount];
+
+    void cast(Viewer& viewer) const;
+    void apply(const Viewer& viewer, bool add);
+    void clear(Viewer& viewer);
+    FactionView& factionView(int faction);
+};
+
+#endif
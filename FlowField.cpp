@@ -0,0 +1,86 @@
+#include "FlowField.h"
+#include "Map.h"
+#include <algorithm>
+
+FlowField::FlowField() : width(0), height(0) {}
+
+void FlowField::clear() {
+    width = 0;
+    height = 0;
+    distances.clear();
+    enterCosts.clear();
+    sources.clear();
+}
+
+void FlowField::compute(const Map& map, const BitBoard& blocked, const std::vector<SDL_Point>& seeds) {
+    width = map.getWidth();
+    height = map.getHeight();
+    sources = seeds;
+    distances.assign(static_cast<size_t>(width) * height, -1);
+    enterCosts.assign(distances.size(), 0);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            enterCosts[static_cast<size_t>(y) * width + x] =
+                static_cast<uint8_t>(std::min(255, map.getMovementCost(x, y)));
+        }
+    }
+
+    if (buckets.empty()) {
+        buckets.resize(1);
+    }
+    for (const SDL_Point& source : sources) {
+        if (!map.isInside(source.x, source.y)) {
+            continue;
+        }
+        const uint32_t cell = static_cast<uint32_t>(source.y * width + source.x);
+        if (distances[cell] != 0) {
+            distances[cell] = 0;
+            buckets[0].push_back(cell);
+        }
+    }
+    // Walking backwards: reaching a neighbour from `cell` means the unit on
+    // the neighbour pays to enter `cell`.
+    const int dirs[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+    int lastCost = 0;
+    for (int cost = 0; cost <= lastCost; ++cost) {
+        for (size_t i = 0; i < buckets[cost].size(); ++i) {
+            const uint32_t cell = buckets[cost][i];
+            if (distances[cell] != cost) {
+                continue;
+            }
+            const int x = static_cast<int>(cell % width);
+            const int y = static_cast<int>(cell / width);
+            const int next = cost + enterCosts[cell];
+            for (const auto& dir : dirs) {
+                const int nx = x + dir[0];
+                const int ny = y + dir[1];
+                if (nx < 0 || ny < 0 || nx >= width || ny >= height || blocked.test(nx, ny)) {
+                    continue;
+                }
+                const uint32_t neighbor = static_cast<uint32_t>(ny * width + nx);
+                if (distances[neighbor] < 0 || next < distances[neighbor]) {
+                    distances[neighbor] = next;
+                    if (buckets.size() <= static_cast<size_t>(next)) {
+                        buckets.resize(next + 1);
+                    }
+                    buckets[next].push_back(neighbor);
+                    lastCost = std::max(lastCost, next);
+                }
+            }
+        }
+        buckets[cost].clear();
+    }
+}
+
+bool FlowField::findSource(const SDL_Point& from, SDL_Point& source) const {
+    if (getDistance(from.x, from.y) < 0) {
+        return false;
+    }
+    // Every step lowers the distance, so this ends on a source.
+    source = from;
+    SDL_Point next;
+    while (descend(source, [](int, int) { return false; }, next)) {
+        source = next;
+    }
+    return true;
+}
@@ -0,0 +1,70 @@
+#ifndef FLOWFIELD_H
+#define FLOWFIELD_H
+
+#include <SDL2/SDL.h>
+#include <cstdint>
+#include <vector>
+#include "BitBoard.h"
+
+class Map;
+
+// Cheapest cost from every tile of the map to the nearest of several
+// sources, paying for each tile entered on the way. One field serves every
+// unit heading for the same sources: each just steps to a cheaper
+// neighbour. Filled with Dial's buckets, like MovementField.
+class FlowField {
+public:
+    FlowField();
+
+    // Tiles set in `blocked` are never crossed; sources cost 0.
+    void compute(const Map& map, const BitBoard& blocked, const std::vector<SDL_Point>& sources);
+    void clear();
+
+    // -1 when no source can be reached from the tile.
+    int getDistance(int x, int y) const {
+        if (x < 0 || y < 0 || x >= width || y >= height) {
+            return -1;
+        }
+        return distances[static_cast<size_t>(y) * width + x];
+    }
+    const std::vector<SDL_Point>& getSources() const { return sources; }
+
+    // The neighbour of `from` that continues most cheaply toward a source,
+    // skipping tiles for which `taken(x, y)` holds. False when no free
+    // neighbour is closer to a source than `from`.
+    template <typename Taken>
+    bool descend(const SDL_Point& from, Taken taken, SDL_Point& next) const {
+        const int here = getDistance(from.x, from.y);
+        if (here <= 0) {
+            return false;
+        }
+        const int dirs[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+        int best = -1;
+        for (const auto& dir : dirs) {
+            const int x = from.x + dir[0];
+            const int y = from.y + dir[1];
+            const int distance = getDistance(x, y);
+            if (distance < 0 || distance >= here || taken(x, y)) {
+                continue;
+            }
+            const int total = distance + enterCosts[static_cast<size_t>(y) * width + x];
+            if (best < 0 || total < best) {
+                best = total;
+                next = {x, y};
+            }
+        }
+        return best >= 0;
+    }
+    // The source reached by descending from `from` with nothing in the way.
+    bool findSource(const SDL_Point& from, SDL_Point& source) const;
+
+private:
+    int width;
+    int height;
+    std::vector<int> distances;
+    std::vector<uint8_t> enterCosts;
+    std::vector<SDL_Point> sources;
+    std::vector<std::vector<uint32_t>> buckets;
+};
+
+#endif
@@ -1,13 +1,18 @@
 #include "Game.h"
 #include <iostream>
-#include <queue>
 #include <sstream>
 #include <cmath>
 
 namespace {
+const char* const kContentPath = "data/game_data.json";
 const int kTileSize = 32;
 const int kSidebarWidth = 320;
+const int kMaxBoardPixelWidth = 1280;
+const int kMaxBoardPixelHeight = 800;
+const int kKeyPanPixels = kTileSize * 2;
+const float kWheelZoomStep = 1.25f;
 const int kAttackCost = 2;
+const int kSightRadius = 8;
 
 bool containsCell(const std::vector<SDL_Point>& cells, int x, int y) {
     for (const auto& cell : cells) {
@@ -32,17 +37,21 @@ Game::Game()
     : isRunning(false),
       window(nullptr),
       renderer(nullptr),
+      playerFieldValid(false),
       uiManager(nullptr),
       gameState(GameState::AwaitingRoll),
       combatSystem(nullptr),
       currentAction(UIActionType::None),
       selectedAbilityIndex(-1),
+      movementField(nullptr),
       enemyTurnPrepared(false),
       waitingForRoll(true),
       gameOverDisplayed(false),
       lastRoundRecorded(1),
       boardPixelWidth(640),
-      boardPixelHeight(640) {}
+      boardPixelHeight(640),
+      draggingCamera(false),
+      showRenderStats(false) {}
 
 Game::~Game() {}
 
@@ -60,55 +69,77 @@ bool Game::init(const char* title, int xpos, int ypos, int width, int height, bo
         return false;
     }
 
-    if (!dataLoader.loadFromFile("data/game_data.json")) {
+    if (!dataLoader.loadFromFile(kContentPath)) {
         return false;
     }
+    if (!contentWatcher.watch(kContentPath)) {
+        std::cerr << "Recarga automatica de conteudo indisponivel." << std::endl;
+    }
     content = dataLoader.getContent();
-    if (content.maps.empty()) {
+    if (content->maps->empty()) {
         std::cerr << "Nenhum mapa encontrado nos dados." << std::endl;
         return false;
     }
-    currentMap = content.maps.begin()->second;
-    boardPixelWidth = currentMap.width * kTileSize;
-    boardPixelHeight = currentMap.height * kTileSize;
+    currentMap = content->maps->get(content->maps->getOrder().front());
+    if (!currentMap) {
+        std::cerr << "Falha ao carregar o mapa inicial." << std::endl;
+        return false;
+    }
+    // Large maps scroll inside a bounded board instead of growing the window.
+    boardPixelWidth = std::min(currentMap->width * kTileSize, kMaxBoardPixelWidth);
+    boardPixelHeight = std::min(currentMap->height * kTileSize, kMaxBoardPixelHeight);
+    camera.setViewport({0, 0, boardPixelWidth, boardPixelHeight});
+    camera.setBoard(currentMap->width, currentMap->height, kTileSize);
 
     window = SDL_CreateWindow(title, xpos, ypos, boardPixelWidth + kSidebarWidth, boardPixelHeight, flags);
-    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_TARGETTEXTURE);
     if (!renderer) {
         std::cerr << "Renderer creation failed: " << SDL_GetError() << std::endl;
         return false;
     }
     SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    batcher.setRenderer(renderer);
+    windowTitle = title;
 
-    map.loadFromDefinition(currentMap, content.terrainTypes);
-    mission = Mission(currentMap.objectives);
+    if (!map.load(*currentMap, content->maps->openTerrain(currentMap->id), content->terrainTypes)) {
+        std::cerr << "Falha ao carregar o terreno do mapa inicial." << std::endl;
+        return false;
+    }
+    fieldOfView.reset(map);
+    pathfinder.build(map);
+    occupancy.reset(map.getWidth(), map.getHeight());
+    mission = Mission(currentMap->objectives);
     combatSystem = new CombatSystem(&dice);
     uiManager = new UIManager(boardPixelWidth, 0, kSidebarWidth, boardPixelHeight);
 
-    for (size_t i = 0; i < currentMap.playerIds.size() && i < currentMap.playerSpawns.size(); ++i) {
-        const auto& id = currentMap.playerIds[i];
-        auto entityIt = content.entities.find(id);
-        if (entityIt == content.entities.end()) continue;
-        players.push_back(std::unique_ptr<PlayerEntity>(new PlayerEntity(entityIt->second, currentMap.playerSpawns[i])));
+    for (size_t i = 0; i < currentMap->playerIds.size() && i < currentMap->playerSpawns.size(); ++i) {
+        Symbol id = currentMap->playerIds[i];
+        auto entityIt = content->entities.find(id);
+        if (entityIt == content->entities.end()) continue;
+        players.push_back(std::unique_ptr<PlayerEntity>(new PlayerEntity(entityIt->second, currentMap->playerSpawns[i])));
+        players.back()->setOccupancyGrid(&occupancy);
         initiativeOrder.push_back(players.back().get());
     }
 
-    for (size_t i = 0; i < currentMap.enemyIds.size() && i < currentMap.enemySpawns.size(); ++i) {
-        const auto& id = currentMap.enemyIds[i];
-        auto entityIt = content.entities.find(id);
-        if (entityIt == content.entities.end()) continue;
-        enemies.push_back(std::unique_ptr<EnemyEntity>(new EnemyEntity(entityIt->second, currentMap.enemySpawns[i])));
+    for (size_t i = 0; i < currentMap->enemyIds.size() && i < currentMap->enemySpawns.size(); ++i) {
+        Symbol id = currentMap->enemyIds[i];
+        auto entityIt = content->entities.find(id);
+        if (entityIt == content->entities.end()) continue;
+        enemies.push_back(std::unique_ptr<EnemyEntity>(new EnemyEntity(entityIt->second, currentMap->enemySpawns[i])));
+        enemies.back()->setOccupancyGrid(&occupancy);
         initiativeOrder.push_back(enemies.back().get());
     }
 
-    for (size_t i = 0; i < currentMap.npcIds.size() && i < currentMap.npcSpawns.size(); ++i) {
-        const auto& id = currentMap.npcIds[i];
-        auto entityIt = content.entities.find(id);
-        if (entityIt == content.entities.end()) continue;
-        npcs.push_back(std::unique_ptr<NpcEntity>(new NpcEntity(entityIt->second, currentMap.npcSpawns[i])));
+    for (size_t i = 0; i < currentMap->npcIds.size() && i < currentMap->npcSpawns.size(); ++i) {
+        Symbol id = currentMap->npcIds[i];
+        auto entityIt = content->entities.find(id);
+        if (entityIt == content->entities.end()) continue;
+        npcs.push_back(std::unique_ptr<NpcEntity>(new NpcEntity(entityIt->second, currentMap->npcSpawns[i])));
+        npcs.back()->setOccupancyGrid(&occupancy);
     }
 
     turnManager.setParticipants(initiativeOrder);
+    refreshVisibility();
     Entity* initial = turnManager.getCurrent();
     refreshAbilityButtons(initial);
     if (initial && initial->getFaction() == EntityFaction::Enemies) {
@@ -116,7 +147,7 @@ bool Game::init(const char* title, int xpos, int ypos, int width, int height, bo
     } else {
         startPlayerTurn(initial);
     }
-    eventLog.addEntry("Missao iniciada: " + currentMap.name);
+    eventLog.addEntry("Missao iniciada: " + currentMap->name);
 
     isRunning = true;
     hoverText = "Passe o mouse sobre o tabuleiro";
@@ -131,15 +162,40 @@ void Game::handleEvents() {
         }
         uiManager->handleEvent(event);
         if (event.type == SDL_MOUSEMOTION) {
+            if (draggingCamera) {
+                camera.pan(-event.motion.xrel, -event.motion.yrel);
+            }
             updateHoverInfo(event.motion.x, event.motion.y);
         }
         if (event.type == SDL_MOUSEBUTTONDOWN && event.button.button == SDL_BUTTON_LEFT) {
-            if (event.button.x < boardPixelWidth && gameState != GameState::EnemyTurn) {
-                int cellX = event.button.x / kTileSize;
-                int cellY = event.button.y / kTileSize;
+            int cellX = 0;
+            int cellY = 0;
+            if (gameState != GameState::EnemyTurn && camera.screenToTile(event.button.x, event.button.y, cellX, cellY)) {
                 handleBoardClick(cellX, cellY);
             }
         }
+        if (event.type == SDL_MOUSEBUTTONDOWN &&
+            (event.button.button == SDL_BUTTON_MIDDLE || event.button.button == SDL_BUTTON_RIGHT)) {
+            SDL_Point point = {event.button.x, event.button.y};
+            draggingCamera = SDL_PointInRect(&point, &camera.getViewport());
+        }
+        if (event.type == SDL_MOUSEBUTTONUP &&
+            (event.button.button == SDL_BUTTON_MIDDLE || event.button.button == SDL_BUTTON_RIGHT)) {
+            draggingCamera = false;
+        }
+        if (event.type == SDL_MOUSEWHEEL && event.wheel.y != 0) {
+            int mouseX = 0;
+            int mouseY = 0;
+            SDL_GetMouseState(&mouseX, &mouseY);
+            SDL_Point point = {mouseX, mouseY};
+            if (SDL_PointInRect(&point, &camera.getViewport())) {
+                camera.zoomAt(event.wheel.y > 0 ? kWheelZoomStep : 1.0f / kWheelZoomStep, mouseX, mouseY);
+                updateHoverInfo(mouseX, mouseY);
+            }
+        }
+        if (event.type == SDL_KEYDOWN) {
+            handleKeyDown(event.key.keysym.sym);
+        }
     }
 
     if (!isRunning) return;
@@ -176,11 +232,66 @@ void Game::handleEvents() {
     }
 }
 
+void Game::handleKeyDown(SDL_Keycode key) {
+    const SDL_Rect& viewport = camera.getViewport();
+    switch (key) {
+        case SDLK_LEFT:
+        case SDLK_a:
+            camera.pan(-kKeyPanPixels, 0);
+            break;
+        case SDLK_RIGHT:
+        case SDLK_d:
+            camera.pan(kKeyPanPixels, 0);
+            break;
+        case SDLK_UP:
+        case SDLK_w:
+            camera.pan(0, -kKeyPanPixels);
+            break;
+        case SDLK_DOWN:
+        case SDLK_s:
+            camera.pan(0, kKeyPanPixels);
+            break;
+        case SDLK_PLUS:
+        case SDLK_EQUALS:
+            camera.zoomAt(kWheelZoomStep, viewport.x + viewport.w / 2, viewport.y + viewport.h / 2);
+            break;
+        case SDLK_MINUS:
+            camera.zoomAt(1.0f / kWheelZoomStep, viewport.x + viewport.w / 2, viewport.y + viewport.h / 2);
+            break;
+        case SDLK_F3:
+            showRenderStats = !showRenderStats;
+            if (!showRenderStats) {
+                SDL_SetWindowTitle(window, windowTitle.c_str());
+                shownTitle.clear();
+            }
+            break;
+        case SDLK_HOME:
+            if (Entity* current = turnManager.getCurrent()) {
+                camera.centerOn(current->getPosition().x, current->getPosition().y);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
 void Game::update() {
+    if (contentWatcher.poll()) {
+        reloadContent();
+    }
+
     for (auto& player : players) player->update();
     for (auto& enemy : enemies) enemy->update();
     for (auto& npc : npcs) npc->update();
 
+    std::vector<SDL_Point> focus;
+    for (const Entity* entity : initiativeOrder) {
+        if (entity->isAlive()) focus.push_back(entity->getPosition());
+    }
+    for (const auto& npc : npcs) focus.push_back(npc->getPosition());
+    map.setFocus(focus);
+    refreshVisibility();
+
     if (gameState == GameState::EnemyTurn) {
         processEnemyTurn();
     }
@@ -192,30 +303,38 @@ void Game::render() {
     SDL_SetRenderDrawColor(renderer, 10, 10, 10, 255);
     SDL_RenderClear(renderer);
 
-    map.drawMap(renderer, true);
+    SDL_RenderSetClipRect(renderer, &camera.getViewport());
+    map.drawMap(batcher, camera, true);
+    drawFog();
     if (!movementHighlights.empty()) {
-        map.drawHighlights(renderer, movementHighlights, SDL_Color{255, 255, 0, 80});
+        map.drawHighlights(batcher, camera, movementHighlights, SDL_Color{255, 255, 0, 80});
     }
     if (!attackHighlights.empty()) {
-        map.drawHighlights(renderer, attackHighlights, SDL_Color{255, 80, 80, 80});
+        map.drawHighlights(batcher, camera, attackHighlights, SDL_Color{255, 80, 80, 80});
     }
     if (!abilityHighlights.empty()) {
-        map.drawHighlights(renderer, abilityHighlights, SDL_Color{80, 120, 255, 80});
+        map.drawHighlights(batcher, camera, abilityHighlights, SDL_Color{80, 120, 255, 80});
     }
 
+    const SDL_Rect visible = camera.getVisibleTiles();
     auto drawEntity = [&](const Entity& entity) {
         if (!entity.isAlive()) return;
-        SDL_Rect rect = {entity.getPosition().x * kTileSize, entity.getPosition().y * kTileSize, kTileSize, kTileSize};
-        SDL_Color color = factionColor(entity);
-        SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
-        SDL_RenderFillRect(renderer, &rect);
-        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-        SDL_RenderDrawRect(renderer, &rect);
+        const SDL_Point& position = entity.getPosition();
+        if (!SDL_PointInRect(&position, &visible)) return;
+        if (entity.getFaction() != EntityFaction::Players &&
+            !fieldOfView.isVisible(EntityFaction::Players, position.x, position.y)) {
+            return;
+        }
+        SDL_Rect rect = camera.tileToScreen(position.x, position.y);
+        batcher.fillRect(RenderLayer::Entities, rect, factionColor(entity));
+        batcher.outlineRect(RenderLayer::EntityOutlines, rect, SDL_Color{0, 0, 0, 255});
     };
 
     for (auto& player : players) drawEntity(*player);
     for (auto& enemy : enemies) drawEntity(*enemy);
     for (auto& npc : npcs) drawEntity(*npc);
+    batcher.flush();
+    SDL_RenderSetClipRect(renderer, nullptr);
 
     uiManager->render(renderer, turnManager.getCurrent(), mission, eventLog.getEntries(), hoverText);
 
@@ -225,6 +344,16 @@ void Game::render() {
     }
 
     SDL_RenderPresent(renderer);
+    batcher.endFrame();
+    if (showRenderStats) {
+        const RenderStats& stats = batcher.getFrameStats();
+        std::string title = windowTitle + " | chamadas de desenho: " + std::to_string(stats.drawCalls) +
+                            " | quads: " + std::to_string(stats.quads);
+        if (title != shownTitle) {
+            SDL_SetWindowTitle(window, title.c_str());
+            shownTitle = title;
+        }
+    }
 }
 
 void Game::clean() {
@@ -233,19 +362,58 @@ void Game::clean() {
     npcs.clear();
     delete combatSystem;
     delete uiManager;
+    map.releaseTextures();
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
     TTF_Quit();
     SDL_Quit();
 }
 
+// Brings field of view in line with unit positions; only units that
+// changed are recast.
+void Game::refreshVisibility() {
+    for (const Entity* entity : initiativeOrder) {
+        fieldOfView.updateViewer(*entity, kSightRadius);
+    }
+}
+
+// Unexplored tiles are hidden and explored ones out of sight are dimmed.
+// Each row is merged into runs so a row costs a few quads at most.
+void Game::drawFog() {
+    const SDL_Rect visible = camera.getVisibleTiles();
+    for (int y = visible.y; y < visible.y + visible.h; ++y) {
+        int runStart = visible.x;
+        int runState = -1;
+        for (int x = visible.x; x <= visible.x + visible.w; ++x) {
+            int state = -1;
+            if (x < visible.x + visible.w) {
+                state = !fieldOfView.isExplored(EntityFaction::Players, x, y) ? 2
+                        : !fieldOfView.isVisible(EntityFaction::Players, x, y) ? 1 : 0;
+            }
+            if (state == runState) {
+                continue;
+            }
+            if (runState > 0) {
+                const SDL_Rect first = camera.tileToScreen(runStart, y);
+                const SDL_Rect last = camera.tileToScreen(x - 1, y);
+                const Uint8 alpha = runState == 2 ? 255 : 140;
+                batcher.fillRect(RenderLayer::Fog, {first.x, first.y, last.x + last.w - first.x, first.h},
+                                 SDL_Color{0, 0, 0, alpha});
+            }
+            runStart = x;
+            runState = state;
+        }
+    }
+}
+
 void Game::startPlayerTurn(Entity* entity) {
     if (!entity) return;
+    camera.ensureVisible(entity->getPosition().x, entity->getPosition().y);
     gameState = GameState::AwaitingRoll;
     waitingForRoll = true;
     currentAction = UIActionType::None;
     selectedAbilityIndex = -1;
-    selectedAbilityId.clear();
+    selectedAbilityId = Symbol();
     refreshAbilityButtons(entity);
     movementHighlights.clear();
     attackHighlights.clear();
@@ -253,6 +421,9 @@ void Game::startPlayerTurn(Entity* entity) {
 }
 
 void Game::startEnemyTurn(Entity* entity) {
+    if (entity) {
+        camera.ensureVisible(entity->getPosition().x, entity->getPosition().y);
+    }
     gameState = GameState::EnemyTurn;
     waitingForRoll = true;
     enemyTurnPrepared = false;
@@ -309,7 +480,7 @@ void Game::evaluateMissions() {
     }
 
     if (!enemiesAlive) {
-        mission.registerEnemyDefeated("");
+        mission.registerEnemyDefeated(Symbol());
     }
 
     if (mission.isComplete()) {
@@ -318,7 +489,7 @@ void Game::evaluateMissions() {
         return;
     }
 
-    if (currentMap.turnLimit > 0 && turnManager.getRoundNumber() > currentMap.turnLimit) {
+    if (currentMap->turnLimit > 0 && turnManager.getRoundNumber() > currentMap->turnLimit) {
         gameState = GameState::GameOver;
         eventLog.addEntry("A partida terminou: limite de turnos atingido.");
     }
@@ -331,19 +502,17 @@ void Game::handleBoardClick(int cellX, int cellY) {
     }
 
     switch (currentAction) {
-    case UIActionType::Move:
-        if (cellY >= 0 && cellY < static_cast<int>(movementCosts.size()) &&
-            cellX >= 0 && cellX < static_cast<int>(movementCosts[cellY].size())) {
-            int cost = movementCosts[cellY][cellX];
-            if (cost > 0 && current->hasActionPoints(cost) && !isTileOccupied(cellX, cellY)) {
-                current->consumeActionPoints(cost);
-                current->setPosition(cellX, cellY);
-                eventLog.addEntry(current->getName() + " moveu para (" + std::to_string(cellX) + "," + std::to_string(cellY) + ")");
-                applyTileEffect(*current);
-                updateHighlights();
-            }
+    case UIActionType::Move: {
+        int cost = movementField ? movementField->getCost(cellX, cellY) : -1;
+        if (cost > 0 && current->hasActionPoints(cost) && !isTileOccupied(cellX, cellY)) {
+            current->consumeActionPoints(cost);
+            current->setPosition(cellX, cellY);
+            eventLog.addEntry(current->getName() + " moveu para (" + std::to_string(cellX) + "," + std::to_string(cellY) + ")");
+            applyTileEffect(*current);
+            updateHighlights();
         }
         break;
+    }
     case UIActionType::Attack: {
         Entity* target = getEntityAt(cellX, cellY);
         if (target && containsCell(attackHighlights, cellX, cellY) &&
@@ -417,56 +586,57 @@ void Game::setCurrentAction(UIActionType action) {
 
 void Game::updateHighlights() {
     movementHighlights.clear();
-    movementCosts.clear();
+    movementField = nullptr;
     attackHighlights.clear();
     abilityHighlights.clear();
 
     Entity* current = turnManager.getCurrent();
     if (!current) return;
+    refreshVisibility();
 
     if (currentAction == UIActionType::Move) {
-        movementCosts = calculateMovementCost(*current, current->getActionPoints());
-        for (int y = 0; y < static_cast<int>(movementCosts.size()); ++y) {
-            for (int x = 0; x < static_cast<int>(movementCosts[y].size()); ++x) {
-                if (movementCosts[y][x] > 0) {
-                    movementHighlights.push_back({x, y});
-                }
-            }
-        }
+        calculateMovementCost(*current, current->getActionPoints());
+        movementHighlights = movementField->getReachableCells();
     } else if (currentAction == UIActionType::Attack) {
-        std::vector<SDL_Point> range = calculateRange(*current, current->getAttackRange());
-        for (const auto& cell : range) {
-            Entity* target = getEntityAt(cell.x, cell.y);
-            if (target && target->getFaction() != current->getFaction()) {
-                attackHighlights.push_back(cell);
+        BitBoard targets = rangeMask(*current, current->getAttackRange());
+        BitBoard others(targets.getArea());
+        for (int faction = 0; faction < kFactionCount; ++faction) {
+            if (faction != static_cast<int>(current->getFaction())) {
+                others |= occupancy.getMask(static_cast<EntityFaction>(faction));
             }
         }
+        targets &= others;
+        fieldOfView.restrictToVisible(*current, targets);
+        attackHighlights = targets.toPoints();
     } else if (currentAction == UIActionType::Ability) {
         const AbilityDefinition* ability = getAbilityDefinition(selectedAbilityId);
         if (ability) {
-            std::vector<SDL_Point> range = calculateRange(*current, ability->range);
-            abilityHighlights = range;
+            BitBoard targets = rangeMask(*current, ability->range);
+            fieldOfView.restrictToVisible(*current, targets);
+            abilityHighlights = targets.toPoints();
             if (ability->targetType == AbilityTargetType::Self) {
                 abilityHighlights.push_back(current->getPosition());
             }
         }
     } else if (currentAction == UIActionType::Interact) {
-        std::vector<SDL_Point> neighbors = calculateRange(*current, 1);
-        for (const auto& cell : neighbors) {
-            if (map.getSpecialType(cell.x, cell.y) != TileSpecialType::None || getEntityAt(cell.x, cell.y)) {
-                abilityHighlights.push_back(cell);
-            }
+        BitBoard neighbors = rangeMask(*current, 1);
+        BitBoard interesting(neighbors.getArea());
+        map.fillSpecials(interesting);
+        for (int faction = 0; faction < kFactionCount; ++faction) {
+            interesting |= occupancy.getMask(static_cast<EntityFaction>(faction));
         }
+        neighbors &= interesting;
+        abilityHighlights = neighbors.toPoints();
     }
 }
 
 void Game::updateHoverInfo(int mouseX, int mouseY) {
-    if (mouseX >= boardPixelWidth) {
-        hoverText = "";
-    } else {
-        int cellX = mouseX / kTileSize;
-        int cellY = mouseY / kTileSize;
+    int cellX = 0;
+    int cellY = 0;
+    if (camera.screenToTile(mouseX, mouseY, cellX, cellY)) {
         hoverText = buildHoverText(cellX, cellY);
+    } else {
+        hoverText = "";
     }
 }
 
@@ -490,123 +660,136 @@ void Game::processEnemyTurn() {
         enemyTurnPrepared = true;
     }
 
+    const SDL_Rect mapArea = {0, 0, map.getWidth(), map.getHeight()};
+    std::vector<SDL_Point> route;
+    size_t routeStep = 0;
     while (enemy->getActionPoints() > 0) {
-        PlayerEntity* closestPlayer = nullptr;
-        int bestDistance = 999;
-        for (auto& player : players) {
-            if (!player->isAlive()) continue;
-            int dist = std::abs(player->getPosition().x - enemy->getPosition().x) +
-                       std::abs(player->getPosition().y - enemy->getPosition().y);
-            if (dist < bestDistance) {
-                bestDistance = dist;
-                closestPlayer = player.get();
+        refreshVisibility();
+        const SDL_Point origin = enemy->getPosition();
+        const int range = enemy->getAttackRange();
+        Entity* target = nullptr;
+        int nearestDistance = -1;
+        occupancy.forEachIn(EntityFaction::Players, {origin.x - range, origin.y - range, 2 * range + 1, 2 * range + 1},
+                            [&](Entity& player) {
+            const SDL_Point position = player.getPosition();
+            int dist = std::abs(position.x - origin.x) + std::abs(position.y - origin.y);
+            if (dist > range || !fieldOfView.canSee(*enemy, position.x, position.y)) return;
+            if (nearestDistance < 0 || dist < nearestDistance) {
+                nearestDistance = dist;
+                target = &player;
             }
-        }
-        if (!closestPlayer) {
-            enemy->setActionPoints(0);
-            break;
-        }
-
-        if (bestDistance <= enemy->getAttackRange() && enemy->hasActionPoints(kAttackCost)) {
+        });
+        if (target && enemy->hasActionPoints(kAttackCost)) {
             enemy->consumeActionPoints(kAttackCost);
-            combatSystem->performBasicAttack(*enemy, *closestPlayer, map, eventLog);
-            if (!closestPlayer->isAlive()) {
-                eventLog.addEntry(closestPlayer->getName() + " caiu em combate.");
+            combatSystem->performBasicAttack(*enemy, *target, map, eventLog);
+            if (!target->isAlive()) {
+                eventLog.addEntry(target->getName() + " caiu em combate.");
             }
+            continue;
+        }
+
+        // Enemies walk down the shared field toward the nearest player. A
+        // detour is planned only when units stand on every way down, and is
+        // followed until it is blocked too.
+        refreshPlayerField();
+        auto taken = [&](int x, int y) { return isTileOccupied(x, y); };
+        SDL_Point next = origin;
+        bool hasStep = false;
+        if (routeStep < route.size() && !taken(route[routeStep].x, route[routeStep].y)) {
+            next = route[routeStep++];
+            hasStep = true;
+        } else if (playerField.descend(origin, taken, next)) {
+            route.clear();
+            hasStep = true;
         } else {
-            int dx = (closestPlayer->getPosition().x > enemy->getPosition().x) ? 1 : (closestPlayer->getPosition().x < enemy->getPosition().x ? -1 : 0);
-            int dy = (closestPlayer->getPosition().y > enemy->getPosition().y) ? 1 : (closestPlayer->getPosition().y < enemy->getPosition().y ? -1 : 0);
-            int targetX = enemy->getPosition().x + (dx != 0 ? dx : 0);
-            int targetY = enemy->getPosition().y + ((dx == 0 && dy != 0) ? dy : 0);
-            if (map.isInside(targetX, targetY) && !map.blocksMovement(targetX, targetY) && !isTileOccupied(targetX, targetY)) {
-                int cost = map.getMovementCost(targetX, targetY);
-                if (enemy->hasActionPoints(cost)) {
-                    enemy->consumeActionPoints(cost);
-                    enemy->setPosition(targetX, targetY);
-                } else {
-                    enemy->setActionPoints(0);
-                }
-            } else {
-                enemy->setActionPoints(0);
+            SDL_Point goal;
+            BitBoard occupied(mapArea);
+            for (int faction = 0; faction < kFactionCount; ++faction) {
+                occupied |= occupancy.getMask(static_cast<EntityFaction>(faction));
+            }
+            routeStep = 0;
+            if (playerField.findSource(origin, goal) &&
+                pathfinder.findPath(origin, goal, route, &occupied, enemy->getActionPoints()) && !route.empty() &&
+                !taken(route[0].x, route[0].y)) {
+                next = route[routeStep++];
+                hasStep = true;
             }
         }
+        int cost = map.getMovementCost(next.x, next.y);
+        if (hasStep && enemy->hasActionPoints(cost)) {
+            enemy->consumeActionPoints(cost);
+            enemy->setPosition(next.x, next.y);
+        } else {
+            enemy->setActionPoints(0);
+        }
     }
 
     endCurrentTurn();
 }
 
-std::vector<SDL_Point> Game::calculateReachableCells(const Entity& entity, int ap) {
-    std::vector<std::vector<int>> costs = calculateMovementCost(entity, ap);
-    std::vector<SDL_Point> cells;
-    for (int y = 0; y < static_cast<int>(costs.size()); ++y) {
-        for (int x = 0; x < static_cast<int>(costs[y].size()); ++x) {
-            if (costs[y][x] > 0) {
-                cells.push_back({x, y});
-            }
-        }
+// Each entity keeps its last field. A field for the same tile is kept as
+// is while occupancy is unchanged, and otherwise checked against the new
+// obstacles before being recomputed; spending AP only lowers its budget.
+void Game::calculateMovementCost(const Entity& entity, int ap) {
+    const SDL_Point origin = entity.getPosition();
+    CachedMovement& cached = movementCache[&entity];
+    movementField = &cached.field;
+    const bool sameTile = cached.field.getMaxCost() >= 0 && cached.field.getOrigin().x == origin.x &&
+                          cached.field.getOrigin().y == origin.y;
+    if (sameTile && ap <= cached.field.getMaxCost() && cached.occupancyVersion == occupancy.getVersion()) {
+        cached.field.limit(ap);
+        return;
     }
-    return cells;
+    BitBoard obstacles({origin.x - ap, origin.y - ap, 2 * ap + 1, 2 * ap + 1});
+    map.fillMovementBlockers(obstacles);
+    for (int faction = 0; faction < kFactionCount; ++faction) {
+        obstacles |= occupancy.getMask(static_cast<EntityFaction>(faction));
+    }
+    if (!sameTile || !cached.field.reuse(map, obstacles, origin, ap)) {
+        cached.field.compute(map, obstacles, origin, ap);
+    }
+    cached.occupancyVersion = occupancy.getVersion();
 }
 
-std::vector<std::vector<int>> Game::calculateMovementCost(const Entity& entity, int ap) {
-    std::vector<std::vector<int>> costs(currentMap.height, std::vector<int>(currentMap.width, -1));
-    std::queue<SDL_Point> frontier;
-    frontier.push(entity.getPosition());
-    costs[entity.getPosition().y][entity.getPosition().x] = 0;
-
-    const int dirs[4][2] = {{1,0},{-1,0},{0,1},{0,-1}};
-    while (!frontier.empty()) {
-        SDL_Point current = frontier.front();
-        frontier.pop();
-        for (const auto& dir : dirs) {
-            int nx = current.x + dir[0];
-            int ny = current.y + dir[1];
-            if (!map.isInside(nx, ny) || map.blocksMovement(nx, ny)) continue;
-            if (isTileOccupied(nx, ny)) continue;
-            int moveCost = map.getMovementCost(nx, ny);
-            int newCost = costs[current.y][current.x] + moveCost;
-            if (newCost == 0) newCost = moveCost;
-            if (newCost <= ap && (costs[ny][nx] == -1 || newCost < costs[ny][nx])) {
-                costs[ny][nx] = newCost;
-                frontier.push({nx, ny});
-            }
-        }
+// The players' field is shared by every enemy and only recomputed when a
+// player moved, fell or the terrain changed.
+void Game::refreshPlayerField() {
+    std::vector<SDL_Point> sources;
+    for (const auto& player : players) {
+        if (player->isAlive()) sources.push_back(player->getPosition());
     }
-
-    return costs;
+    const std::vector<SDL_Point>& current = playerField.getSources();
+    bool same = playerFieldValid && sources.size() == current.size();
+    for (size_t i = 0; same && i < sources.size(); ++i) {
+        same = sources[i].x == current[i].x && sources[i].y == current[i].y;
+    }
+    if (same) {
+        return;
+    }
+    BitBoard blocked({0, 0, map.getWidth(), map.getHeight()});
+    map.fillMovementBlockers(blocked);
+    playerField.compute(map, blocked, sources);
+    playerFieldValid = true;
 }
 
-std::vector<SDL_Point> Game::calculateRange(const Entity& entity, int distance) const {
-    std::vector<SDL_Point> result;
-    SDL_Point pos = entity.getPosition();
-    for (int y = pos.y - distance; y <= pos.y + distance; ++y) {
-        for (int x = pos.x - distance; x <= pos.x + distance; ++x) {
-            if (!map.isInside(x, y)) continue;
-            if (std::abs(x - pos.x) + std::abs(y - pos.y) <= distance && !(x == pos.x && y == pos.y)) {
-                result.push_back({x, y});
-            }
-        }
-    }
-    return result;
+BitBoard Game::rangeMask(const Entity& entity, int distance) const {
+    const SDL_Point pos = entity.getPosition();
+    BitBoard mask = BitBoard::diamond(pos, distance, {0, 0, map.getWidth(), map.getHeight()});
+    mask.clear(pos.x, pos.y);
+    return mask;
 }
 
-Entity* Game::getEntityAt(int x, int y) {
-    for (auto& player : players) if (player->isAlive() && player->getPosition().x == x && player->getPosition().y == y) return player.get();
-    for (auto& enemy : enemies) if (enemy->isAlive() && enemy->getPosition().x == x && enemy->getPosition().y == y) return enemy.get();
-    for (auto& npc : npcs) if (npc->isAlive() && npc->getPosition().x == x && npc->getPosition().y == y) return npc.get();
-    return nullptr;
+Entity* Game::getEntityAt(int x, int y) const {
+    return occupancy.getEntityAt(x, y);
 }
 
 bool Game::isTileOccupied(int x, int y) const {
-    for (const auto& player : players) if (player->isAlive() && player->getPosition().x == x && player->getPosition().y == y) return true;
-    for (const auto& enemy : enemies) if (enemy->isAlive() && enemy->getPosition().x == x && enemy->getPosition().y == y) return true;
-    for (const auto& npc : npcs) if (npc->isAlive() && npc->getPosition().x == x && npc->getPosition().y == y) return true;
-    return false;
+    return occupancy.isOccupied(x, y);
 }
 
 void Game::applyTileEffect(Entity& entity) {
     TileSpecialType type = map.getSpecialType(entity.getPosition().x, entity.getPosition().y);
-    SpecialTileDefinition def = map.getSpecialDefinition(entity.getPosition().x, entity.getPosition().y);
+    const SpecialTileDefinition& def = map.getSpecialDefinition(entity.getPosition().x, entity.getPosition().y);
     switch (type) {
     case TileSpecialType::Trap:
         entity.takeDamage(def.value);
@@ -617,16 +800,9 @@ void Game::applyTileEffect(Entity& entity) {
         eventLog.addEntry(entity.getName() + " recuperou " + std::to_string(def.value) + " HP.");
         break;
     case TileSpecialType::Portal:
-        if (!def.targetId.empty()) {
-            size_t comma = def.targetId.find(',');
-            if (comma != std::string::npos) {
-                int tx = std::stoi(def.targetId.substr(0, comma));
-                int ty = std::stoi(def.targetId.substr(comma + 1));
-                if (map.isInside(tx, ty)) {
-                    entity.setPosition(tx, ty);
-                    eventLog.addEntry("Portal transportou " + entity.getName());
-                }
-            }
+        if (map.isInside(def.targetX, def.targetY) && !isTileOccupied(def.targetX, def.targetY)) {
+            entity.setPosition(def.targetX, def.targetY);
+            eventLog.addEntry("Portal transportou " + entity.getName());
         }
         break;
     case TileSpecialType::Item:
@@ -646,8 +822,9 @@ std::string Game::buildHoverText(int cellX, int cellY) const {
     if (!map.isInside(cellX, cellY)) return "";
     std::ostringstream info;
     info << "Celula (" << cellX << "," << cellY << ")";
-    Entity* entity = const_cast<Game*>(this)->getEntityAt(cellX, cellY);
-    if (entity) {
+    Entity* entity = getEntityAt(cellX, cellY);
+    if (entity && (entity->getFaction() == EntityFaction::Players ||
+                   fieldOfView.isVisible(EntityFaction::Players, cellX, cellY))) {
         info << " - " << entity->getName() << " HP " << entity->getCurrentHP();
     }
     TileSpecialType special = map.getSpecialType(cellX, cellY);
@@ -661,24 +838,74 @@ void Game::refreshAbilityButtons(const Entity* entity) {
     if (!entity) return;
     std::vector<AbilityButtonEntry> entries;
     for (const auto& abilityId : entity->getAbilityIds()) {
-        auto abilityIt = content.abilities.find(abilityId);
-        if (abilityIt != content.abilities.end()) {
+        auto abilityIt = content->abilities.find(abilityId);
+        if (abilityIt != content->abilities.end()) {
             entries.push_back({abilityId, abilityIt->second.name});
         }
     }
     uiManager->setAbilities(entries);
 }
 
-const AbilityDefinition* Game::getAbilityDefinition(const std::string& id) const {
-    auto it = content.abilities.find(id);
-    if (it == content.abilities.end()) return nullptr;
+const AbilityDefinition* Game::getAbilityDefinition(Symbol id) const {
+    auto it = content->abilities.find(id);
+    if (it == content->abilities.end()) return nullptr;
     return &it->second;
 }
 
+void Game::reloadContent() {
+    ContentChanges changes;
+    if (!dataLoader.reloadChanged(kContentPath, changes)) {
+        eventLog.addEntry("Falha ao recarregar o conteudo; mantendo a versao atual.");
+        return;
+    }
+    if (changes.empty()) return;
+
+    // Entities point into the snapshot being replaced, so it is kept alive
+    // until all of them have moved to the new one.
+    std::shared_ptr<const GameContent> previous = std::move(content);
+    content = dataLoader.getContent();
+    auto rebind = [&](Entity& entity) {
+        auto it = content->entities.find(entity.getId());
+        if (it != content->entities.end()) {
+            entity.rebindDefinition(it->second);
+        }
+    };
+    for (auto& player : players) rebind(*player);
+    for (auto& enemy : enemies) rebind(*enemy);
+    for (auto& npc : npcs) rebind(*npc);
+    previous.reset();
+    for (Symbol id : changes.terrain) {
+        auto it = content->terrainTypes.find(id);
+        if (it != content->terrainTypes.end()) {
+            map.updateTerrainType(it->second);
+        }
+    }
+    for (Symbol id : changes.maps) {
+        if (id != currentMap->id) continue;
+        auto updated = content->maps->get(id);
+        if (updated && map.patchTerrain(updated, content->terrainTypes)) {
+            currentMap = updated;
+        } else {
+            eventLog.addEntry("Mapa atual alterado; as mudancas valem no proximo carregamento.");
+        }
+    }
+
+    if (!changes.terrain.empty() || !changes.maps.empty()) {
+        fieldOfView.invalidate();
+        pathfinder.build(map);
+        movementCache.clear();
+        movementField = nullptr;
+        playerFieldValid = false;
+    }
+    refreshAbilityButtons(turnManager.getCurrent());
+    updateHighlights();
+    eventLog.addEntry("Conteudo recarregado: " + std::to_string(changes.size()) + " registros alterados.");
+}
+
 std::string Game::serializeState() const {
     std::ostringstream out;
     out << "{";
-    out << "\"map\":\"" << currentMap.id << "\",";
+    out << "\"map\":\"" << symbolName(currentMap->id) << "\",";
     out << "\"turn\":" << turnManager.getRoundNumber() << ",";
     out << "\"entities\":[";
     bool first = true;
@@ -686,7 +913,7 @@ std::string Game::serializeState() const {
         if (!first) out << ",";
         first = false;
         out << "{";
-        out << "\"id\":\"" << entity.getId() << "\",";
+        out << "\"id\":\"" << symbolName(entity.getId()) << "\",";
         out << "\"hp\":" << entity.getCurrentHP() << ",";
         out << "\"energy\":" << entity.getCurrentEnergy() << ",";
         out << "\"level\":" << entity.getLevel() << ",";
@@ -4,8 +4,12 @@
 #include <vector>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <SDL2/SDL.h>
+#include "Camera.h"
 #include "Map.h"
+#include "MovementField.h"
+#include "RenderBatcher.h"
 #include "Entity.h"
 #include "TurnManager.h"
 #include "Dice.h"
@@ -15,6 +19,11 @@
 #include "Mission.h"
 #include "EventLog.h"
 #include "CombatSystem.h"
+#include "ContentWatcher.h"
+#include "FieldOfView.h"
+#include "FlowField.h"
+#include "HierarchicalPathfinder.h"
+#include "OccupancyGrid.h"
 
 class Game {
 public:
@@ -38,22 +47,34 @@ private:
     void setCurrentAction(UIActionType action);
     void updateHighlights();
     void updateHoverInfo(int mouseX, int mouseY);
+    void handleKeyDown(SDL_Keycode key);
     void processEnemyTurn();
-    std::vector<SDL_Point> calculateReachableCells(const Entity& entity, int ap);
-    std::vector<std::vector<int>> calculateMovementCost(const Entity& entity, int ap);
-    std::vector<SDL_Point> calculateRange(const Entity& entity, int distance) const;
-    Entity* getEntityAt(int x, int y);
+    void calculateMovementCost(const Entity& entity, int ap);
+    BitBoard rangeMask(const Entity& entity, int distance) const;
+    Entity* getEntityAt(int x, int y) const;
     bool isTileOccupied(int x, int y) const;
     void applyTileEffect(Entity& entity);
     std::string buildHoverText(int cellX, int cellY) const;
     void refreshAbilityButtons(const Entity* entity);
-    const AbilityDefinition* getAbilityDefinition(const std::string& id) const;
+    const AbilityDefinition* getAbilityDefinition(Symbol id) const;
     std::string serializeState() const;
+    void reloadContent();
+    void refreshVisibility();
+    void refreshPlayerField();
+    void drawFog();
 
     bool isRunning;
     SDL_Window* window;
     SDL_Renderer* renderer;
+    RenderBatcher batcher;
     Map map;
+    FieldOfView fieldOfView;
+    HierarchicalPathfinder pathfinder;
+    // Distance to the nearest living player, for every enemy to descend.
+    FlowField playerField;
+    bool playerFieldValid;
+    Camera camera;
+    OccupancyGrid occupancy;
     std::vector<std::unique_ptr<PlayerEntity>> players;
     std::vector<std::unique_ptr<EnemyEntity>> enemies;
     std::vector<std::unique_ptr<NpcEntity>> npcs;
@@ -63,17 +84,25 @@ private:
     UIManager* uiManager;
     GameState gameState;
     GameDataLoader dataLoader;
-    GameContent content;
-    MapDefinition currentMap;
+    ContentWatcher contentWatcher;
+    std::shared_ptr<const GameContent> content;
+    std::shared_ptr<const MapDefinition> currentMap;
     Mission mission;
     EventLog eventLog;
     CombatSystem* combatSystem;
 
     UIActionType currentAction;
     int selectedAbilityIndex;
-    std::string selectedAbilityId;
+    Symbol selectedAbilityId;
     std::vector<SDL_Point> movementHighlights;
-    std::vector<std::vector<int>> movementCosts;
+    // Reachability per entity, reused while its tile, AP and the units
+    // around it allow; movementField is the current entity's.
+    struct CachedMovement {
+        MovementField field;
+        uint64_t occupancyVersion = 0;
+    };
+    std::unordered_map<const Entity*, CachedMovement> movementCache;
+    const MovementField* movementField;
     std::vector<SDL_Point> attackHighlights;
     std::vector<SDL_Point> abilityHighlights;
     std::string hoverText;
@@ -84,6 +113,11 @@ private:
 
     int boardPixelWidth;
     int boardPixelHeight;
+    bool draggingCamera;
+    // F3 shows the last frame's board draw calls in the window title.
+    bool showRenderStats;
+    std::string windowTitle;
+    std::string shownTitle;
 };
 
 #endif // GAME_H
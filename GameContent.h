@@ -1,10 +1,14 @@
 #ifndef GAMECONTENT_H
 #define GAMECONTENT_H
 
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 #include <unordered_map>
 #include <SDL2/SDL.h>
+#include "MapCatalog.h"
+#include "Symbol.h"
 
 enum class EntityFaction {
     Players,
@@ -12,6 +16,8 @@ enum class EntityFaction {
     Neutral
 };
 
+const int kFactionCount = 3;
+
 enum class EntityKind {
     Player,
     Enemy,
@@ -65,7 +71,7 @@ struct Attributes {
 };
 
 struct AbilityDefinition {
-    std::string id;
+    Symbol id;
     std::string name;
     std::string description;
     int apCost = 0;
@@ -74,16 +80,30 @@ struct AbilityDefinition {
     AbilityTargetType targetType = AbilityTargetType::Enemy;
     AbilityEffectType effectType = AbilityEffectType::Damage;
     int power = 0;
+    // Status left by buffs, debuffs and status abilities; set by the loaders
+    // with resolveAbilityStatus so combat never interns names.
+    Symbol statusId;
 };
 
+inline void resolveAbilityStatus(AbilityDefinition& ability) {
+    std::string name;
+    switch (ability.effectType) {
+    case AbilityEffectType::Buff: name = "buff_"; break;
+    case AbilityEffectType::Debuff: name = "debuff_"; break;
+    default: ability.statusId = ability.id; return;
+    }
+    name += symbolName(ability.id);
+    ability.statusId = internSymbol(name);
+}
+
 struct ItemDefinition {
-    std::string id;
+    Symbol id;
     std::string name;
     std::string description;
 };
 
 struct EntityDefinition {
-    std::string id;
+    Symbol id;
     std::string name;
     std::string dialog;
     EntityKind kind = EntityKind::Player;
@@ -93,12 +113,12 @@ struct EntityDefinition {
     int maxEnergy = 50;
     int baseAttack = 5;
     int attackRange = 1;
-    std::vector<std::string> abilityIds;
-    std::vector<std::string> passiveEffects;
+    std::vector<Symbol> abilityIds;
+    std::vector<Symbol> passiveEffects;
 };
 
 struct TerrainTypeDefinition {
-    std::string id;
+    Symbol id;
     std::string name;
     int movementCost = 1;
     int defenseModifier = 0;
@@ -113,13 +133,16 @@ struct SpecialTileDefinition {
     int x = 0;
     int y = 0;
     int value = 0;
-    std::string targetId;
+    // Item/objective id; portals use targetX/targetY instead.
+    Symbol targetId;
+    int targetX = -1;
+    int targetY = -1;
 };
 
 struct MissionObjectiveDefinition {
     ObjectiveType type = ObjectiveType::DefeatEnemies;
     std::string description;
-    std::string targetId;
+    Symbol targetId;
     int amount = 0;
     int turnLimit = 0;
     int targetX = -1;
@@ -127,31 +150,51 @@ struct MissionObjectiveDefinition {
 };
 
 struct MapDefinition {
-    std::string id;
+    Symbol id;
     std::string name;
     int width = 0;
     int height = 0;
-    std::vector<std::vector<std::string>> terrainIds;
+    // Empty for large maps built from a content pack; read those through
+    // MapCatalog::openTerrain.
+    std::vector<std::vector<Symbol>> terrainIds;
     std::string rhythm;
     GameModeType mode = GameModeType::Cooperative;
     int turnLimit = 0;
     std::vector<SpecialTileDefinition> specials;
     std::vector<MissionObjectiveDefinition> objectives;
     std::vector<std::string> loseConditions;
-    std::vector<std::string> playerIds;
-    std::vector<std::string> enemyIds;
-    std::vector<std::string> npcIds;
+    std::vector<Symbol> playerIds;
+    std::vector<Symbol> enemyIds;
+    std::vector<Symbol> npcIds;
     std::vector<SDL_Point> playerSpawns;
     std::vector<SDL_Point> enemySpawns;
     std::vector<SDL_Point> npcSpawns;
 };
 
+enum class ContentSection {
+    Terrain,
+    Abilities,
+    Items,
+    Entities,
+    Maps,
+    Unknown
+};
+
+// Hash of one source record's raw bytes, used to find what an edit touched.
+struct ContentRecordDigest {
+    ContentSection section = ContentSection::Unknown;
+    uint64_t hash = 0;
+};
+
 struct GameContent {
-    std::unordered_map<std::string, TerrainTypeDefinition> terrainTypes;
-    std::unordered_map<std::string, AbilityDefinition> abilities;
-    std::unordered_map<std::string, ItemDefinition> items;
-    std::unordered_map<std::string, EntityDefinition> entities;
-    std::unordered_map<std::string, MapDefinition> maps;
+    SymbolMap<TerrainTypeDefinition> terrainTypes;
+    SymbolMap<AbilityDefinition> abilities;
+    SymbolMap<ItemDefinition> items;
+    SymbolMap<EntityDefinition> entities;
+    // Shared by copies of the content and only changed by the loader, which
+    // clones it before editing a published snapshot. The first map in order
+    // is the starting map.
+    std::shared_ptr<const MapCatalog> maps = std::make_shared<MapCatalog>();
 };
 
 #endif
@@ -1,242 +1,820 @@
 #include "GameDataLoader.h"
-#include <fstream>
-#include <sstream>
+#include "ContentPack.h"
+#include "ContentSchema.h"
+#include "JsonStructuralIndex.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <functional>
 #include <iostream>
+#include <numeric>
+#include <unordered_set>
 
-GameDataLoader::GameDataLoader() {}
+namespace {
+// Feeds each element of the top-level section arrays to `onRecord` as its
+// own small document, so only one record is ever held as a DOM.
+class ContentStreamHandler : public SimpleJsonHandler {
+public:
+    using RecordCallback = std::function<void(ContentSection, const SimpleJsonValue&)>;
 
-bool GameDataLoader::loadFromFile(const std::string& path) {
-    std::ifstream file(path);
-    if (!file.is_open()) {
-        std::cerr << "Unable to open data file: " << path << std::endl;
-        return false;
+    ContentStreamHandler(std::string_view input, RecordCallback callback)
+        : record(input),
+          onRecord(std::move(callback)),
+          depth(0),
+          rootIsObject(false),
+          sectionIsArray(false),
+          inRecord(false),
+          section(ContentSection::Unknown) {}
+
+    void startObject() override {
+        if (startRecord()) {
+            record.startObject();
+            return;
+        }
+        if (depth == 0) rootIsObject = true;
+        if (depth == 1) sectionIsArray = false;
+        depth++;
     }
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    SimpleJsonParser parser(buffer.str());
-    SimpleJsonValue root = parser.parse();
 
-    loadTerrain(root["terrain_types"]);
-    loadAbilities(root["abilities"]);
-    loadItems(root["items"]);
-    loadEntities(root["entities"]);
-    loadMaps(root["maps"]);
+    void key(std::string_view name) override {
+        if (inRecord) {
+            record.key(name);
+        } else if (depth == 1) {
+            section = GameDataLoader::sectionFromKey(name);
+        }
+    }
 
-    return true;
-}
+    void endObject() override {
+        if (inRecord) {
+            record.endObject();
+            finishRecord();
+            return;
+        }
+        depth--;
+    }
 
-void GameDataLoader::loadTerrain(const SimpleJsonValue& node) {
-    if (node.getType() != SimpleJsonValue::Type::Array) return;
-    for (const auto& entry : node.asArray()) {
-        TerrainTypeDefinition def;
-        def.id = entry["id"].asString();
-        def.name = entry["name"].asString(def.id);
-        def.movementCost = entry["movement_cost"].asInt(1);
-        def.defenseModifier = entry["defense_bonus"].asInt(0);
-        def.dodgeModifier = entry["evasion_bonus"].asInt(0);
-        def.blocksMovement = entry["blocks_movement"].asBool(false);
-        def.blocksLineOfSight = entry["blocks_los"].asBool(false);
-        const auto& colorNode = entry["color"];
-        if (colorNode.getType() == SimpleJsonValue::Type::Array) {
-            const auto& arr = colorNode.asArray();
-            if (arr.size() >= 3) {
-                def.color.r = arr[0].asInt(0);
-                def.color.g = arr[1].asInt(0);
-                def.color.b = arr[2].asInt(0);
-                def.color.a = arr.size() > 3 ? arr[3].asInt(255) : 255;
-            }
+    void startArray() override {
+        if (startRecord()) {
+            record.startArray();
+            return;
         }
-        content.terrainTypes[def.id] = def;
-    }
-}
-
-void GameDataLoader::loadAbilities(const SimpleJsonValue& node) {
-    if (node.getType() != SimpleJsonValue::Type::Array) return;
-    for (const auto& entry : node.asArray()) {
-        AbilityDefinition def;
-        def.id = entry["id"].asString();
-        def.name = entry["name"].asString(def.id);
-        def.description = entry["description"].asString();
-        def.apCost = entry["ap_cost"].asInt(0);
-        def.energyCost = entry["energy_cost"].asInt(0);
-        def.range = entry["range"].asInt(1);
-        def.targetType = parseAbilityTarget(entry["target"].asString("enemy"));
-        def.effectType = parseEffectType(entry["effect"].asString("damage"));
-        def.power = entry["power"].asInt(0);
-        content.abilities[def.id] = def;
-    }
-}
-
-void GameDataLoader::loadItems(const SimpleJsonValue& node) {
-    if (node.getType() != SimpleJsonValue::Type::Array) return;
-    for (const auto& entry : node.asArray()) {
-        ItemDefinition def;
-        def.id = entry["id"].asString();
-        def.name = entry["name"].asString(def.id);
-        def.description = entry["description"].asString();
-        content.items[def.id] = def;
-    }
-}
-
-void GameDataLoader::loadEntities(const SimpleJsonValue& node) {
-    if (node.getType() != SimpleJsonValue::Type::Array) return;
-    for (const auto& entry : node.asArray()) {
-        EntityDefinition def;
-        def.id = entry["id"].asString();
-        def.name = entry["name"].asString(def.id);
-        def.dialog = entry["dialog"].asString();
-        def.kind = parseEntityKind(entry["kind"].asString("player"));
-        def.faction = parseFaction(entry["faction"].asString("players"));
-        def.attributes.strength = entry["strength"].asInt(3);
-        def.attributes.agility = entry["agility"].asInt(3);
-        def.attributes.intelligence = entry["intelligence"].asInt(3);
-        def.attributes.defense = entry["defense"].asInt(3);
-        def.maxHP = entry["hp"].asInt(100);
-        def.maxEnergy = entry["energy"].asInt(50);
-        def.baseAttack = entry["attack"].asInt(10);
-        def.attackRange = entry["range"].asInt(1);
-        if (entry["abilities"].getType() == SimpleJsonValue::Type::Array) {
-            for (const auto& abilityNode : entry["abilities"].asArray()) {
-                def.abilityIds.push_back(abilityNode.asString());
-            }
+        if (depth == 1) sectionIsArray = rootIsObject;
+        depth++;
+    }
+
+    void endArray() override {
+        if (inRecord) {
+            record.endArray();
+            finishRecord();
+            return;
         }
-        if (entry["passives"].getType() == SimpleJsonValue::Type::Array) {
-            for (const auto& passiveNode : entry["passives"].asArray()) {
-                def.passiveEffects.push_back(passiveNode.asString());
+        depth--;
+    }
+
+    void nullValue() override {
+        if (startRecord()) record.nullValue();
+        finishRecord();
+    }
+
+    void boolValue(bool value) override {
+        if (startRecord()) record.boolValue(value);
+        finishRecord();
+    }
+
+    void numberValue(double value) override {
+        if (startRecord()) record.numberValue(value);
+        finishRecord();
+    }
+
+    void stringValue(std::string_view value) override {
+        if (startRecord()) record.stringValue(value);
+        finishRecord();
+    }
+
+private:
+    SimpleJsonDocumentBuilder record;
+    RecordCallback onRecord;
+    int depth;
+    bool rootIsObject;
+    bool sectionIsArray;
+    bool inRecord;
+    ContentSection section;
+
+    bool startRecord() {
+        if (inRecord) return true;
+        if (depth != 2 || !sectionIsArray || section == ContentSection::Unknown) return false;
+        record.clear();
+        inRecord = true;
+        return true;
+    }
+
+    void finishRecord() {
+        if (!inRecord || !record.isComplete()) return;
+        inRecord = false;
+        onRecord(section, record.root());
+    }
+};
+
+class NullJsonHandler : public SimpleJsonHandler {
+public:
+    void startObject() override {}
+    void key(std::string_view) override {}
+    void endObject() override {}
+    void startArray() override {}
+    void endArray() override {}
+    void nullValue() override {}
+    void boolValue(bool) override {}
+    void numberValue(double) override {}
+    void stringValue(std::string_view) override {}
+};
+
+// Finds record boundaries by matching brackets and skipping strings. It does
+// not validate record contents; each record is parsed properly afterwards.
+class ContentRecordScanner {
+public:
+    ContentRecordScanner(std::string_view data, std::vector<ContentRecordSpan>& output)
+        : input(data), index(0), records(output), structural(data) {}
+
+    bool scan() {
+        skipWhitespace();
+        if (!match('{')) return false;
+        while (true) {
+            skipWhitespace();
+            if (match('}')) return true;
+            std::string_view name;
+            if (!scanKey(name)) return false;
+            skipWhitespace();
+            if (!match(':')) return false;
+            skipWhitespace();
+            ContentSection section = GameDataLoader::sectionFromKey(name);
+            if (section != ContentSection::Unknown && peek() == '[') {
+                if (!scanSection(section)) return false;
+            } else if (!skipAndValidate()) {
+                return false;
             }
+            skipWhitespace();
+            if (match(',')) continue;
+            return match('}');
         }
-        content.entities[def.id] = def;
-    }
-}
-
-void GameDataLoader::loadMaps(const SimpleJsonValue& node) {
-    if (node.getType() != SimpleJsonValue::Type::Array) return;
-    for (const auto& entry : node.asArray()) {
-        MapDefinition def;
-        def.id = entry["id"].asString();
-        def.name = entry["name"].asString(def.id);
-        def.width = entry["width"].asInt(20);
-        def.height = entry["height"].asInt(20);
-        def.rhythm = entry["rhythm"].asString("short");
-        def.mode = parseGameMode(entry["mode"].asString("cooperative"));
-        def.turnLimit = entry["turn_limit"].asInt(0);
-
-        const auto& rowsNode = entry["rows"];
-        if (rowsNode.getType() == SimpleJsonValue::Type::Array) {
-            for (const auto& row : rowsNode.asArray()) {
-                std::vector<std::string> rowIds;
-                const auto& rowValues = row.asArray();
-                for (const auto& value : rowValues) {
-                    rowIds.push_back(value.asString("plain"));
+    }
+
+private:
+    std::string_view input;
+    size_t index;
+    std::vector<ContentRecordSpan>& records;
+    JsonStructuralIndex structural;
+
+    char peek() const { return index < input.size() ? input[index] : '\0'; }
+
+    bool match(char expected) {
+        if (peek() != expected) return false;
+        index++;
+        return true;
+    }
+
+    void skipWhitespace() {
+        if (index < input.size() && std::isspace(static_cast<unsigned char>(input[index]))) {
+            index = structural.nextAtOrAfter(index);
+        }
+    }
+
+    bool scanKey(std::string_view& name) {
+        if (!match('"')) return false;
+        size_t end = structural.nextAtOrAfter(index);
+        if (end >= input.size()) return false;
+        name = input.substr(index, end - index);
+        if (name.find('\\') != std::string_view::npos) return false;
+        index = end + 1;
+        return true;
+    }
+
+    bool scanSection(ContentSection section) {
+        match('[');
+        while (true) {
+            skipWhitespace();
+            if (match(']')) return true;
+            size_t start = index;
+            if (!skipValue()) return false;
+            records.push_back({section, start, index - start});
+            skipWhitespace();
+            if (match(',')) continue;
+            return match(']');
+        }
+    }
+
+    bool skipString() {
+        size_t end = structural.nextAtOrAfter(index + 1);
+        if (end >= input.size()) return false;
+        index = end + 1;
+        return true;
+    }
+
+    bool skipValue() {
+        char current = peek();
+        if (current == '"') {
+            return skipString();
+        }
+        if (current == '{' || current == '[') {
+            // Brackets inside strings are never indexed, so only depth matters.
+            int depth = 0;
+            size_t position = index;
+            while (true) {
+                position = structural.nextAtOrAfter(position);
+                if (position >= input.size()) return false;
+                char c = input[position++];
+                if (c == '{' || c == '[') {
+                    depth++;
+                } else if ((c == '}' || c == ']') && --depth == 0) {
+                    index = position;
+                    return true;
                 }
-                def.terrainIds.push_back(rowIds);
             }
         }
+        size_t start = index;
+        while (index < input.size() &&
+               (std::isalnum(static_cast<unsigned char>(input[index])) || input[index] == '-' || input[index] == '.')) {
+            index++;
+        }
+        return index > start;
+    }
 
-        const auto& specialsNode = entry["special_tiles"];
-        if (specialsNode.getType() == SimpleJsonValue::Type::Array) {
-            for (const auto& special : specialsNode.asArray()) {
-                SpecialTileDefinition specialDef;
-                specialDef.type = parseSpecialType(special["type"].asString("none"));
-                specialDef.x = special["x"].asInt(0);
-                specialDef.y = special["y"].asInt(0);
-                specialDef.value = special["value"].asInt(0);
-                specialDef.targetId = special["target"].asString();
-                def.specials.push_back(specialDef);
-            }
+    // Values outside the content sections are ignored, but a malformed one
+    // must still fail the load as it would under the full parser.
+    bool skipAndValidate() {
+        size_t start = index;
+        if (!skipValue()) return false;
+        try {
+            NullJsonHandler ignore;
+            SimpleJsonParser parser(input.substr(start, index - start));
+            parser.parse(ignore);
+            return parser.getPosition() == index - start;
+        } catch (const std::exception&) {
+            return false;
         }
+    }
+};
+}
 
-        const auto& objectivesNode = entry["objectives"];
-        if (objectivesNode.getType() == SimpleJsonValue::Type::Array) {
-            for (const auto& obj : objectivesNode.asArray()) {
-                MissionObjectiveDefinition missionDef;
-                missionDef.type = parseObjectiveType(obj["type"].asString("defeat"));
-                missionDef.description = obj["description"].asString();
-                missionDef.targetId = obj["target"].asString();
-                missionDef.amount = obj["amount"].asInt(0);
-                missionDef.turnLimit = obj["turns"].asInt(0);
-                missionDef.targetX = obj["x"].asInt(-1);
-                missionDef.targetY = obj["y"].asInt(-1);
-                def.objectives.push_back(missionDef);
-            }
+GameDataLoader::GameDataLoader()
+    : content(std::make_shared<GameContent>()), maps(std::make_shared<MapCatalog>()),
+      mapBudget(MapCatalog::kDefaultBudgetBytes) {
+    content->maps = maps;
+}
+
+bool GameDataLoader::loadFromFile(const std::string& path) {
+    ContentSourceStamp stamp;
+    if (!ContentPack::statSource(path, stamp)) {
+        std::cerr << "Unable to open data file: " << path << std::endl;
+        return false;
+    }
+    const std::string packPath = ContentPack::pathFor(path);
+    auto pack = std::make_shared<ContentPack>();
+    if (pack->open(packPath) && pack->matchesFileStat(stamp) && loadFromPack(pack)) {
+        return true;
+    }
+
+    MappedFile file;
+    if (!file.open(path)) {
+        std::cerr << "Unable to open data file: " << path << std::endl;
+        return false;
+    }
+    stamp.hash = ContentPack::hashBytes(file.view());
+    if (pack->isOpen() && pack->getSourceHash() == stamp.hash && loadFromPack(pack)) {
+        pack->updateStamp(packPath, stamp);
+        return true;
+    }
+
+    loadFromJson(file.view());
+    if (!ContentPack::write(packPath, *content, stamp, recordDigests)) {
+        std::cerr << "Unable to write content pack: " << packPath << std::endl;
+        return true;
+    }
+    // Switch to the new pack so maps can be evicted and rebuilt from it; the
+    // JSON file itself may be rewritten in place by an editor at any time.
+    auto fresh = std::make_shared<ContentPack>();
+    if (fresh->open(packPath)) {
+        loadFromPack(fresh);
+    }
+    return true;
+}
+
+bool GameDataLoader::buildPack(const std::string& path) {
+    MappedFile file;
+    ContentSourceStamp stamp;
+    if (!file.open(path) || !ContentPack::statSource(path, stamp)) {
+        std::cerr << "Unable to open data file: " << path << std::endl;
+        return false;
+    }
+    stamp.hash = ContentPack::hashBytes(file.view());
+    maps = std::make_shared<MapCatalog>();
+    maps->setBudget(mapBudget);
+    content = std::make_shared<GameContent>();
+    content->maps = maps;
+    recordDigests.clear();
+    loadFromJson(file.view());
+    const std::string packPath = ContentPack::pathFor(path);
+    if (!ContentPack::write(packPath, *content, stamp, recordDigests)) {
+        std::cerr << "Unable to write content pack: " << packPath << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void GameDataLoader::setMapBudget(size_t bytes) {
+    mapBudget = bytes;
+    editableMaps().setBudget(bytes);
+}
+
+void GameDataLoader::setWorkerThreads(size_t count) {
+    workers.reset(new WorkerPool(count));
+}
+
+// Record-parallel parsing only pays for its split pass with helper threads;
+// on one core the spans are just hashed for reloads and the JSON streamed.
+void GameDataLoader::loadFromJson(std::string_view json) {
+    std::vector<ContentRecordSpan> records;
+    std::vector<ContentRecordDigest> digests;
+    ContentPatch parsed;
+    if (indexRecords(json, records)) {
+        digests = hashRecords(json, records);
+        if (getWorkers().getThreadCount() == 0) {
+            streamFromJson(json);
+            recordDigests = std::move(digests);
+            return;
+        }
+        std::vector<size_t> all(records.size());
+        std::iota(all.begin(), all.end(), 0);
+        if (parseRecords(json, records, all, parsed)) {
+            apply(std::move(parsed));
+            recordDigests = std::move(digests);
+            return;
         }
+    }
+    recordDigests.clear();
+    streamFromJson(json);
+}
 
-        const auto& losesNode = entry["lose_conditions"];
-        if (losesNode.getType() == SimpleJsonValue::Type::Array) {
-            for (const auto& lose : losesNode.asArray()) {
-                def.loseConditions.push_back(lose.asString());
-            }
+bool GameDataLoader::reloadChanged(const std::string& path, ContentChanges& changes) {
+    MappedFile file;
+    if (!file.open(path)) {
+        std::cerr << "Unable to open data file: " << path << std::endl;
+        return false;
+    }
+    std::vector<ContentRecordSpan> records;
+    if (!indexRecords(file.view(), records)) {
+        std::cerr << "Unable to reload " << path << ": unexpected layout" << std::endl;
+        return false;
+    }
+    std::vector<ContentRecordDigest> digests = hashRecords(file.view(), records);
+
+    std::unordered_set<uint64_t> known;
+    for (const auto& digest : recordDigests) {
+        known.insert(digestKey(digest));
+    }
+    std::vector<size_t> changed;
+    for (size_t i = 0; i < records.size(); ++i) {
+        if (known.find(digestKey(digests[i])) == known.end()) {
+            changed.push_back(i);
         }
+    }
 
-        const auto& playersNode = entry["player_ids"];
-        if (playersNode.getType() == SimpleJsonValue::Type::Array) {
-            for (const auto& pid : playersNode.asArray()) {
-                def.playerIds.push_back(pid.asString());
-            }
+    ContentPatch parsed;
+    if (!parseRecords(file.view(), records, changed, parsed)) {
+        std::cerr << "Unable to reload " << path << ": invalid record" << std::endl;
+        return false;
+    }
+    changes = ContentChanges();
+    auto collect = [](const auto& defs, std::vector<Symbol>& ids) {
+        for (const auto& def : defs) ids.push_back(def.id);
+    };
+    collect(parsed.terrain, changes.terrain);
+    collect(parsed.abilities, changes.abilities);
+    collect(parsed.items, changes.items);
+    collect(parsed.entities, changes.entities);
+    collect(parsed.maps, changes.maps);
+    apply(std::move(parsed));
+    recordDigests = std::move(digests);
+    return true;
+}
+
+uint64_t GameDataLoader::digestKey(const ContentRecordDigest& digest) {
+    return digest.hash ^ (static_cast<uint64_t>(digest.section) * 0x9E3779B97F4A7C15ULL);
+}
+
+bool GameDataLoader::indexRecords(std::string_view json, std::vector<ContentRecordSpan>& records) {
+    records.clear();
+    ContentRecordScanner scanner(json, records);
+    return scanner.scan();
+}
+
+WorkerPool& GameDataLoader::getWorkers() {
+    if (!workers) {
+        workers.reset(new WorkerPool());
+    }
+    return *workers;
+}
+
+// Copy on write: once a snapshot has been handed out, changes go to a copy
+// that becomes the next snapshot.
+GameContent& GameDataLoader::editableContent() {
+    if (content.use_count() > 1) {
+        auto copy = std::make_shared<GameContent>(*content);
+        maps = content->maps->clone();
+        copy->maps = maps;
+        content = std::move(copy);
+    }
+    return *content;
+}
+
+MapCatalog& GameDataLoader::editableMaps() {
+    editableContent();
+    return *maps;
+}
+
+std::vector<ContentRecordDigest> GameDataLoader::hashRecords(std::string_view json,
+                                                             const std::vector<ContentRecordSpan>& records) {
+    std::vector<ContentRecordDigest> digests(records.size());
+    getWorkers().parallelFor(records.size(), [&](size_t i) {
+        digests[i].section = records[i].section;
+        digests[i].hash = ContentPack::hashBytes(json.substr(records[i].offset, records[i].length));
+    });
+    return digests;
+}
+
+// Parses and converts the selected records on the worker pool. Results keep
+// file order within each section, so storing them reproduces a sequential
+// load exactly. Returns false if any selected record fails.
+bool GameDataLoader::parseRecords(std::string_view json, const std::vector<ContentRecordSpan>& records,
+                                  const std::vector<size_t>& selected, ContentPatch& parsed) {
+    std::vector<size_t> slots(selected.size());
+    for (size_t i = 0; i < selected.size(); ++i) {
+        switch (records[selected[i]].section) {
+        case ContentSection::Terrain: slots[i] = parsed.terrain.size(); parsed.terrain.emplace_back(); break;
+        case ContentSection::Abilities: slots[i] = parsed.abilities.size(); parsed.abilities.emplace_back(); break;
+        case ContentSection::Items: slots[i] = parsed.items.size(); parsed.items.emplace_back(); break;
+        case ContentSection::Entities: slots[i] = parsed.entities.size(); parsed.entities.emplace_back(); break;
+        case ContentSection::Maps: slots[i] = parsed.maps.size(); parsed.maps.emplace_back(); break;
+        case ContentSection::Unknown: break;
         }
+    }
 
-        const auto& enemiesNode = entry["enemy_ids"];
-        if (enemiesNode.getType() == SimpleJsonValue::Type::Array) {
-            for (const auto& eid : enemiesNode.asArray()) {
-                def.enemyIds.push_back(eid.asString());
+    // Largest records first, so one big map does not finish last alone.
+    std::vector<size_t> order(selected.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return records[selected[a]].length > records[selected[b]].length;
+    });
+
+    std::vector<char> loaded(selected.size(), 0);
+    getWorkers().parallelFor(order.size(), [&](size_t i) {
+        size_t slot = order[i];
+        const ContentRecordSpan& span = records[selected[slot]];
+        try {
+            std::string_view text = json.substr(span.offset, span.length);
+            SimpleJsonParser parser(text);
+            SimpleJsonDocument document = parser.parse();
+            if (parser.getPosition() != text.size()) return;
+            const SimpleJsonValue& entry = document.root();
+            switch (span.section) {
+            case ContentSection::Terrain: parsed.terrain[slots[slot]] = readTerrain(entry); break;
+            case ContentSection::Abilities: parsed.abilities[slots[slot]] = readAbility(entry); break;
+            case ContentSection::Items: parsed.items[slots[slot]] = readItem(entry); break;
+            case ContentSection::Entities: parsed.entities[slots[slot]] = readEntity(entry); break;
+            case ContentSection::Maps: parsed.maps[slots[slot]] = readMap(entry); break;
+            case ContentSection::Unknown: break;
             }
+            loaded[slot] = 1;
+        } catch (...) {
         }
+    });
+    return std::find(loaded.begin(), loaded.end(), 0) == loaded.end();
+}
 
-        const auto& npcsNode = entry["npc_ids"];
-        if (npcsNode.getType() == SimpleJsonValue::Type::Array) {
-            for (const auto& nid : npcsNode.asArray()) {
-                def.npcIds.push_back(nid.asString());
-            }
+void GameDataLoader::apply(ContentPatch&& parsed) {
+    for (auto& def : parsed.terrain) store(std::move(def));
+    for (auto& def : parsed.abilities) store(std::move(def));
+    for (auto& def : parsed.items) store(std::move(def));
+    for (auto& def : parsed.entities) store(std::move(def));
+    for (auto& def : parsed.maps) store(std::move(def));
+}
+
+void GameDataLoader::streamFromJson(std::string_view json) {
+    ContentStreamHandler handler(json, [this](ContentSection section, const SimpleJsonValue& entry) {
+        loadRecord(section, entry);
+    });
+    SimpleJsonParser parser(json);
+    parser.parse(handler);
+}
+
+bool GameDataLoader::loadFromPack(const std::shared_ptr<const ContentPack>& pack) {
+    GameContent packed;
+    auto catalog = std::make_shared<MapCatalog>();
+    if (!pack->read(packed, *catalog)) {
+        return false;
+    }
+    catalog->setSource(pack);
+    catalog->setBudget(mapBudget);
+    packed.maps = catalog;
+    content = std::make_shared<GameContent>(std::move(packed));
+    maps = std::move(catalog);
+    if (!pack->readDigests(recordDigests)) {
+        recordDigests.clear();
+    }
+    return true;
+}
+
+void GameDataLoader::loadFromDocument(const SimpleJsonValue& root) {
+    const ContentSection sections[] = {
+        ContentSection::Terrain,
+        ContentSection::Abilities,
+        ContentSection::Items,
+        ContentSection::Entities,
+        ContentSection::Maps
+    };
+    for (ContentSection section : sections) {
+        const SimpleJsonValue& node = root[sectionKey(section)];
+        if (node.getType() != SimpleJsonValue::Type::Array) continue;
+        for (const auto& entry : node.asArray()) {
+            loadRecord(section, entry);
         }
+    }
+}
+
+void GameDataLoader::loadRecord(ContentSection section, const SimpleJsonValue& entry) {
+    switch (section) {
+    case ContentSection::Terrain: store(readTerrain(entry)); break;
+    case ContentSection::Abilities: store(readAbility(entry)); break;
+    case ContentSection::Items: store(readItem(entry)); break;
+    case ContentSection::Entities: store(readEntity(entry)); break;
+    case ContentSection::Maps: store(readMap(entry)); break;
+    case ContentSection::Unknown: break;
+    }
+}
+
+void GameDataLoader::store(TerrainTypeDefinition&& def) {
+    editableContent().terrainTypes[def.id] = std::move(def);
+}
 
-        const auto& playerSpawnsNode = entry["player_spawns"];
-        if (playerSpawnsNode.getType() == SimpleJsonValue::Type::Array) {
-            for (const auto& spawnNode : playerSpawnsNode.asArray()) {
-                SDL_Point spawn = {spawnNode["x"].asInt(0), spawnNode["y"].asInt(0)};
-                def.playerSpawns.push_back(spawn);
+void GameDataLoader::store(AbilityDefinition&& def) {
+    editableContent().abilities[def.id] = std::move(def);
+}
+
+void GameDataLoader::store(ItemDefinition&& def) {
+    editableContent().items[def.id] = std::move(def);
+}
+
+void GameDataLoader::store(EntityDefinition&& def) {
+    editableContent().entities[def.id] = std::move(def);
+}
+
+void GameDataLoader::store(MapDefinition&& def) {
+    editableMaps().add(std::move(def));
+}
+
+ContentSection GameDataLoader::sectionFromKey(std::string_view key) {
+    if (key == "terrain_types") return ContentSection::Terrain;
+    if (key == "abilities") return ContentSection::Abilities;
+    if (key == "items") return ContentSection::Items;
+    if (key == "entities") return ContentSection::Entities;
+    if (key == "maps") return ContentSection::Maps;
+    return ContentSection::Unknown;
+}
+
+std::string_view GameDataLoader::sectionKey(ContentSection section) {
+    switch (section) {
+    case ContentSection::Terrain: return "terrain_types";
+    case ContentSection::Abilities: return "abilities";
+    case ContentSection::Items: return "items";
+    case ContentSection::Entities: return "entities";
+    case ContentSection::Maps: return "maps";
+    case ContentSection::Unknown: break;
+    }
+    return "";
+}
+
+TerrainTypeDefinition GameDataLoader::readTerrain(const SimpleJsonValue& entry) {
+    using Def = TerrainTypeDefinition;
+    static constexpr FieldBinding<Def> fields[] = {
+        {"id", [](Def& d, const SimpleJsonValue& v) { d.id = internSymbol(v.asStringView()); }},
+        {"name", [](Def& d, const SimpleJsonValue& v) { readName(v, d.id, d.name); }},
+        {"movement_cost", [](Def& d, const SimpleJsonValue& v) { d.movementCost = v.asInt(1); }},
+        {"defense_bonus", [](Def& d, const SimpleJsonValue& v) { d.defenseModifier = v.asInt(0); }},
+        {"evasion_bonus", [](Def& d, const SimpleJsonValue& v) { d.dodgeModifier = v.asInt(0); }},
+        {"blocks_movement", [](Def& d, const SimpleJsonValue& v) { d.blocksMovement = v.asBool(false); }},
+        {"blocks_los", [](Def& d, const SimpleJsonValue& v) { d.blocksLineOfSight = v.asBool(false); }},
+        {"color", [](Def& d, const SimpleJsonValue& v) {
+            if (v.getType() != SimpleJsonValue::Type::Array) return;
+            const auto& arr = v.asArray();
+            if (arr.size() >= 3) {
+                d.color.r = arr[0].asInt(0);
+                d.color.g = arr[1].asInt(0);
+                d.color.b = arr[2].asInt(0);
+                d.color.a = arr.size() > 3 ? arr[3].asInt(255) : 255;
             }
-        }
+        }},
+    };
+    static constexpr auto schema = makeSchema(fields);
+    return schema.read(entry);
+}
+
+AbilityDefinition GameDataLoader::readAbility(const SimpleJsonValue& entry) {
+    using Def = AbilityDefinition;
+    static constexpr FieldBinding<Def> fields[] = {
+        {"id", [](Def& d, const SimpleJsonValue& v) { d.id = internSymbol(v.asStringView()); }},
+        {"name", [](Def& d, const SimpleJsonValue& v) { readName(v, d.id, d.name); }},
+        {"description", [](Def& d, const SimpleJsonValue& v) { d.description = v.asString(); }},
+        {"ap_cost", [](Def& d, const SimpleJsonValue& v) { d.apCost = v.asInt(0); }},
+        {"energy_cost", [](Def& d, const SimpleJsonValue& v) { d.energyCost = v.asInt(0); }},
+        {"range", [](Def& d, const SimpleJsonValue& v) { d.range = v.asInt(1); }},
+        {"target", [](Def& d, const SimpleJsonValue& v) { d.targetType = parseAbilityTarget(v.asStringView("enemy")); }},
+        {"effect", [](Def& d, const SimpleJsonValue& v) { d.effectType = parseEffectType(v.asStringView("damage")); }},
+        {"power", [](Def& d, const SimpleJsonValue& v) { d.power = v.asInt(0); }},
+    };
+    static constexpr auto schema = makeSchema(fields);
+    Def def = schema.read(entry);
+    resolveAbilityStatus(def);
+    return def;
+}
 
-        const auto& enemySpawnsNode = entry["enemy_spawns"];
-        if (enemySpawnsNode.getType() == SimpleJsonValue::Type::Array) {
-            for (const auto& spawnNode : enemySpawnsNode.asArray()) {
-                SDL_Point spawn = {spawnNode["x"].asInt(0), spawnNode["y"].asInt(0)};
-                def.enemySpawns.push_back(spawn);
+ItemDefinition GameDataLoader::readItem(const SimpleJsonValue& entry) {
+    using Def = ItemDefinition;
+    static constexpr FieldBinding<Def> fields[] = {
+        {"id", [](Def& d, const SimpleJsonValue& v) { d.id = internSymbol(v.asStringView()); }},
+        {"name", [](Def& d, const SimpleJsonValue& v) { readName(v, d.id, d.name); }},
+        {"description", [](Def& d, const SimpleJsonValue& v) { d.description = v.asString(); }},
+    };
+    static constexpr auto schema = makeSchema(fields);
+    return schema.read(entry);
+}
+
+EntityDefinition GameDataLoader::readEntity(const SimpleJsonValue& entry) {
+    using Def = EntityDefinition;
+    static constexpr FieldBinding<Def> fields[] = {
+        {"id", [](Def& d, const SimpleJsonValue& v) { d.id = internSymbol(v.asStringView()); }},
+        {"name", [](Def& d, const SimpleJsonValue& v) { readName(v, d.id, d.name); }},
+        {"dialog", [](Def& d, const SimpleJsonValue& v) { d.dialog = v.asString(); }},
+        {"kind", [](Def& d, const SimpleJsonValue& v) { d.kind = parseEntityKind(v.asStringView("player")); }},
+        {"faction", [](Def& d, const SimpleJsonValue& v) { d.faction = parseFaction(v.asStringView("players")); }},
+        {"strength", [](Def& d, const SimpleJsonValue& v) { d.attributes.strength = v.asInt(3); }},
+        {"agility", [](Def& d, const SimpleJsonValue& v) { d.attributes.agility = v.asInt(3); }},
+        {"intelligence", [](Def& d, const SimpleJsonValue& v) { d.attributes.intelligence = v.asInt(3); }},
+        {"defense", [](Def& d, const SimpleJsonValue& v) { d.attributes.defense = v.asInt(3); }},
+        {"hp", [](Def& d, const SimpleJsonValue& v) { d.maxHP = v.asInt(100); }},
+        {"energy", [](Def& d, const SimpleJsonValue& v) { d.maxEnergy = v.asInt(50); }},
+        {"attack", [](Def& d, const SimpleJsonValue& v) { d.baseAttack = v.asInt(10); }},
+        {"range", [](Def& d, const SimpleJsonValue& v) { d.attackRange = v.asInt(1); }},
+        {"abilities", [](Def& d, const SimpleJsonValue& v) { readSymbols(v, d.abilityIds); }},
+        {"passives", [](Def& d, const SimpleJsonValue& v) { readSymbols(v, d.passiveEffects); }},
+    };
+    static constexpr auto schema = makeSchema(fields);
+    return schema.read(entry);
+}
+
+MapDefinition GameDataLoader::readMap(const SimpleJsonValue& entry) {
+    static constexpr FieldBinding<SpecialTileDefinition> specialFields[] = {
+        {"type", [](SpecialTileDefinition& d, const SimpleJsonValue& v) {
+            d.type = parseSpecialType(v.asStringView("none"));
+        }},
+        {"x", [](SpecialTileDefinition& d, const SimpleJsonValue& v) { d.x = v.asInt(0); }},
+        {"y", [](SpecialTileDefinition& d, const SimpleJsonValue& v) { d.y = v.asInt(0); }},
+        {"value", [](SpecialTileDefinition& d, const SimpleJsonValue& v) { d.value = v.asInt(0); }},
+        {"target", [](SpecialTileDefinition& d, const SimpleJsonValue& v) {
+            if (d.type == TileSpecialType::Portal) {
+                parsePortalTarget(v.asStringView(), d.targetX, d.targetY);
+            } else {
+                d.targetId = internSymbol(v.asStringView());
             }
-        }
+        }},
+    };
+    static constexpr auto specialSchema = makeSchema(specialFields);
 
-        const auto& npcSpawnsNode = entry["npc_spawns"];
-        if (npcSpawnsNode.getType() == SimpleJsonValue::Type::Array) {
-            for (const auto& spawnNode : npcSpawnsNode.asArray()) {
-                SDL_Point spawn = {spawnNode["x"].asInt(0), spawnNode["y"].asInt(0)};
-                def.npcSpawns.push_back(spawn);
+    static constexpr FieldBinding<MissionObjectiveDefinition> objectiveFields[] = {
+        {"type", [](MissionObjectiveDefinition& d, const SimpleJsonValue& v) {
+            d.type = parseObjectiveType(v.asStringView("defeat"));
+        }},
+        {"description", [](MissionObjectiveDefinition& d, const SimpleJsonValue& v) { d.description = v.asString(); }},
+        {"target", [](MissionObjectiveDefinition& d, const SimpleJsonValue& v) {
+            d.targetId = internSymbol(v.asStringView());
+        }},
+        {"amount", [](MissionObjectiveDefinition& d, const SimpleJsonValue& v) { d.amount = v.asInt(0); }},
+        {"turns", [](MissionObjectiveDefinition& d, const SimpleJsonValue& v) { d.turnLimit = v.asInt(0); }},
+        {"x", [](MissionObjectiveDefinition& d, const SimpleJsonValue& v) { d.targetX = v.asInt(-1); }},
+        {"y", [](MissionObjectiveDefinition& d, const SimpleJsonValue& v) { d.targetY = v.asInt(-1); }},
+    };
+    static constexpr auto objectiveSchema = makeSchema(objectiveFields);
+
+    using Def = MapDefinition;
+    static constexpr FieldBinding<Def> fields[] = {
+        {"id", [](Def& d, const SimpleJsonValue& v) { d.id = internSymbol(v.asStringView()); }},
+        {"name", [](Def& d, const SimpleJsonValue& v) { readName(v, d.id, d.name); }},
+        {"width", [](Def& d, const SimpleJsonValue& v) { d.width = v.asInt(20); }},
+        {"height", [](Def& d, const SimpleJsonValue& v) { d.height = v.asInt(20); }},
+        {"rhythm", [](Def& d, const SimpleJsonValue& v) { d.rhythm = v.asString("short"); }},
+        {"mode", [](Def& d, const SimpleJsonValue& v) { d.mode = parseGameMode(v.asStringView("cooperative")); }},
+        {"turn_limit", [](Def& d, const SimpleJsonValue& v) { d.turnLimit = v.asInt(0); }},
+        {"rows", [](Def& d, const SimpleJsonValue& v) { readTerrainRows(v, d.terrainIds); }},
+        {"special_tiles", [](Def& d, const SimpleJsonValue& v) {
+            if (v.getType() != SimpleJsonValue::Type::Array) return;
+            for (const auto& special : v.asArray()) {
+                d.specials.push_back(specialSchema.read(special));
             }
-        }
+        }},
+        {"objectives", [](Def& d, const SimpleJsonValue& v) {
+            if (v.getType() != SimpleJsonValue::Type::Array) return;
+            for (const auto& objective : v.asArray()) {
+                d.objectives.push_back(objectiveSchema.read(objective));
+            }
+        }},
+        {"lose_conditions", [](Def& d, const SimpleJsonValue& v) {
+            if (v.getType() != SimpleJsonValue::Type::Array) return;
+            for (const auto& lose : v.asArray()) {
+                d.loseConditions.push_back(lose.asString());
+            }
+        }},
+        {"player_ids", [](Def& d, const SimpleJsonValue& v) { readSymbols(v, d.playerIds); }},
+        {"enemy_ids", [](Def& d, const SimpleJsonValue& v) { readSymbols(v, d.enemyIds); }},
+        {"npc_ids", [](Def& d, const SimpleJsonValue& v) { readSymbols(v, d.npcIds); }},
+        {"player_spawns", [](Def& d, const SimpleJsonValue& v) { readPoints(v, d.playerSpawns); }},
+        {"enemy_spawns", [](Def& d, const SimpleJsonValue& v) { readPoints(v, d.enemySpawns); }},
+        {"npc_spawns", [](Def& d, const SimpleJsonValue& v) { readPoints(v, d.npcSpawns); }},
+    };
+    static constexpr auto schema = makeSchema(fields);
+    return schema.read(entry);
+}
+
+// Missing or non-string names fall back to the record id.
+void GameDataLoader::readName(const SimpleJsonValue& value, Symbol id, std::string& name) {
+    if (value.getType() == SimpleJsonValue::Type::String) {
+        name = value.asString();
+    } else {
+        name = std::string(symbolName(id));
+    }
+}
+
+void GameDataLoader::readSymbols(const SimpleJsonValue& value, std::vector<Symbol>& symbols) {
+    if (value.getType() != SimpleJsonValue::Type::Array) return;
+    for (const auto& item : value.asArray()) {
+        symbols.push_back(internSymbol(item.asStringView()));
+    }
+}
 
-        content.maps[def.id] = def;
+void GameDataLoader::readPoints(const SimpleJsonValue& value, std::vector<SDL_Point>& points) {
+    static constexpr FieldBinding<SDL_Point> fields[] = {
+        {"x", [](SDL_Point& p, const SimpleJsonValue& v) { p.x = v.asInt(0); }},
+        {"y", [](SDL_Point& p, const SimpleJsonValue& v) { p.y = v.asInt(0); }},
+    };
+    static constexpr auto schema = makeSchema(fields);
+    if (value.getType() != SimpleJsonValue::Type::Array) return;
+    for (const auto& item : value.asArray()) {
+        points.push_back(schema.read(item));
     }
 }
 
-EntityKind GameDataLoader::parseEntityKind(const std::string& value) {
+void GameDataLoader::readTerrainRows(const SimpleJsonValue& value, std::vector<std::vector<Symbol>>& rows) {
+    if (value.getType() != SimpleJsonValue::Type::Array) return;
+    // Rows are long runs of a few terrain ids; skip the interner lookup
+    // while the id repeats.
+    std::string_view lastText;
+    Symbol lastId;
+    bool haveLast = false;
+    for (const auto& row : value.asArray()) {
+        std::vector<Symbol> rowIds;
+        const auto& rowValues = row.asArray();
+        rowIds.reserve(rowValues.size());
+        for (const auto& cell : rowValues) {
+            std::string_view text = cell.asStringView("plain");
+            if (!haveLast || text != lastText) {
+                lastText = text;
+                lastId = internSymbol(text);
+                haveLast = true;
+            }
+            rowIds.push_back(lastId);
+        }
+        rows.push_back(std::move(rowIds));
+    }
+}
+
+EntityKind GameDataLoader::parseEntityKind(std::string_view value) {
     if (value == "enemy") return EntityKind::Enemy;
     if (value == "npc") return EntityKind::Npc;
     return EntityKind::Player;
 }
 
-EntityFaction GameDataLoader::parseFaction(const std::string& value) {
+EntityFaction GameDataLoader::parseFaction(std::string_view value) {
     if (value == "enemies") return EntityFaction::Enemies;
     if (value == "neutral") return EntityFaction::Neutral;
     return EntityFaction::Players;
 }
 
-AbilityTargetType GameDataLoader::parseAbilityTarget(const std::string& value) {
+AbilityTargetType GameDataLoader::parseAbilityTarget(std::string_view value) {
     if (value == "self") return AbilityTargetType::Self;
     if (value == "ally") return AbilityTargetType::Ally;
     if (value == "area") return AbilityTargetType::Area;
     return AbilityTargetType::Enemy;
 }
 
-AbilityEffectType GameDataLoader::parseEffectType(const std::string& value) {
+AbilityEffectType GameDataLoader::parseEffectType(std::string_view value) {
     if (value == "heal") return AbilityEffectType::Heal;
     if (value == "buff") return AbilityEffectType::Buff;
     if (value == "debuff") return AbilityEffectType::Debuff;
@@ -244,14 +822,14 @@ AbilityEffectType GameDataLoader::parseEffectType(const std::string& value) {
     return AbilityEffectType::Damage;
 }
 
-GameModeType GameDataLoader::parseGameMode(const std::string& value) {
+GameModeType GameDataLoader::parseGameMode(std::string_view value) {
     if (value == "free_for_all") return GameModeType::FreeForAll;
     if (value == "survival") return GameModeType::Survival;
     if (value == "points") return GameModeType::Points;
     return GameModeType::Cooperative;
 }
 
-ObjectiveType GameDataLoader::parseObjectiveType(const std::string& value) {
+ObjectiveType GameDataLoader::parseObjectiveType(std::string_view value) {
     if (value == "talk") return ObjectiveType::TalkToNpc;
     if (value == "collect") return ObjectiveType::CollectItem;
     if (value == "reach") return ObjectiveType::ReachTile;
@@ -259,7 +837,7 @@ ObjectiveType GameDataLoader::parseObjectiveType(const std::string& value) {
     return ObjectiveType::DefeatEnemies;
 }
 
-TileSpecialType GameDataLoader::parseSpecialType(const std::string& value) {
+TileSpecialType GameDataLoader::parseSpecialType(std::string_view value) {
     if (value == "trap") return TileSpecialType::Trap;
     if (value == "heal") return TileSpecialType::Heal;
     if (value == "portal") return TileSpecialType::Portal;
@@ -267,3 +845,23 @@ TileSpecialType GameDataLoader::parseSpecialType(const std::string& value) {
     if (value == "item") return TileSpecialType::Item;
     return TileSpecialType::None;
 }
+
+bool GameDataLoader::parsePortalTarget(std::string_view value, int& x, int& y) {
+    size_t comma = value.find(',');
+    if (comma == std::string_view::npos) {
+        return false;
+    }
+    std::string_view xText = value.substr(0, comma);
+    std::string_view yText = value.substr(comma + 1);
+    while (!xText.empty() && xText.front() == ' ') xText.remove_prefix(1);
+    while (!yText.empty() && yText.front() == ' ') yText.remove_prefix(1);
+    int parsedX = 0;
+    int parsedY = 0;
+    if (std::from_chars(xText.data(), xText.data() + xText.size(), parsedX).ec != std::errc() ||
+        std::from_chars(yText.data(), yText.data() + yText.size(), parsedY).ec != std::errc()) {
+        return false;
+    }
+    x = parsedX;
+    y = parsedY;
+    return true;
+}
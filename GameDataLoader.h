@@ -1,32 +1,125 @@
 #ifndef GAMEDATALOADER_H
 #define GAMEDATALOADER_H
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
+#include "ContentPack.h"
 #include "GameContent.h"
+#include "MappedFile.h"
 #include "SimpleJson.h"
+#include "WorkerPool.h"
+
+// Byte range of one element of a top-level section array.
+struct ContentRecordSpan {
+    ContentSection section;
+    size_t offset;
+    size_t length;
+};
+
+// Definitions read from a subset of the source records, in file order.
+struct ContentPatch {
+    std::vector<TerrainTypeDefinition> terrain;
+    std::vector<AbilityDefinition> abilities;
+    std::vector<ItemDefinition> items;
+    std::vector<EntityDefinition> entities;
+    std::vector<MapDefinition> maps;
+
+    size_t size() const { return terrain.size() + abilities.size() + items.size() + entities.size() + maps.size(); }
+    bool empty() const { return size() == 0; }
+};
+
+// Ids of the records a reload replaced, in file order. The definitions
+// themselves are read from the new content snapshot.
+struct ContentChanges {
+    std::vector<Symbol> terrain;
+    std::vector<Symbol> abilities;
+    std::vector<Symbol> items;
+    std::vector<Symbol> entities;
+    std::vector<Symbol> maps;
+
+    size_t size() const { return terrain.size() + abilities.size() + items.size() + entities.size() + maps.size(); }
+    bool empty() const { return size() == 0; }
+};
 
 class GameDataLoader {
 public:
     GameDataLoader();
+    // Uses the compiled .edpak next to `path` when it is current; otherwise
+    // streams the JSON record by record and regenerates the pack.
     bool loadFromFile(const std::string& path);
-    const GameContent& getContent() const { return content; }
+    bool buildPack(const std::string& path);
+    // Keeps every map resident: `json` is not guaranteed to outlive the load.
+    void loadFromJson(std::string_view json);
+    void loadFromDocument(const SimpleJsonValue& root);
+    // Re-reads `path` and loads only the records whose text changed since
+    // the last load, listing them in `changes`. Records removed from the
+    // file stay loaded. On error the current content is left untouched.
+    bool reloadChanged(const std::string& path, ContentChanges& changes);
+    // Frozen view of the loaded content. Later loads and reloads publish a
+    // new snapshot instead of changing this one, so any number of holders
+    // can share it.
+    std::shared_ptr<const GameContent> getContent() const { return content; }
+    // Approximate bytes of built map definitions kept in the catalog.
+    void setMapBudget(size_t bytes);
+    // Helper threads for record-parallel loading, defaulting to one per
+    // extra core. With none, loads stream the JSON on the calling thread.
+    void setWorkerThreads(size_t count);
+
+    static ContentSection sectionFromKey(std::string_view key);
+    static std::string_view sectionKey(ContentSection section);
+    // Splits `json` into record spans without building any values. Returns
+    // false when the layout is not the plain object-of-arrays this expects;
+    // callers then fall back to the full parser for its error reporting.
+    static bool indexRecords(std::string_view json, std::vector<ContentRecordSpan>& records);
+
+    static TerrainTypeDefinition readTerrain(const SimpleJsonValue& entry);
+    static AbilityDefinition readAbility(const SimpleJsonValue& entry);
+    static ItemDefinition readItem(const SimpleJsonValue& entry);
+    static EntityDefinition readEntity(const SimpleJsonValue& entry);
+    static MapDefinition readMap(const SimpleJsonValue& entry);
 
 private:
-    GameContent content;
-
-    void loadTerrain(const SimpleJsonValue& root);
-    void loadAbilities(const SimpleJsonValue& root);
-    void loadItems(const SimpleJsonValue& root);
-    void loadEntities(const SimpleJsonValue& root);
-    void loadMaps(const SimpleJsonValue& root);
-
-    static EntityKind parseEntityKind(const std::string& value);
-    static EntityFaction parseFaction(const std::string& value);
-    static AbilityTargetType parseAbilityTarget(const std::string& value);
-    static AbilityEffectType parseEffectType(const std::string& value);
-    static GameModeType parseGameMode(const std::string& value);
-    static ObjectiveType parseObjectiveType(const std::string& value);
-    static TileSpecialType parseSpecialType(const std::string& value);
+    std::shared_ptr<GameContent> content;
+    // Writable handle on content->maps.
+    std::shared_ptr<MapCatalog> maps;
+    std::unique_ptr<WorkerPool> workers;
+    size_t mapBudget;
+    std::vector<ContentRecordDigest> recordDigests;
+
+    WorkerPool& getWorkers();
+    GameContent& editableContent();
+    MapCatalog& editableMaps();
+    bool loadFromPack(const std::shared_ptr<const ContentPack>& pack);
+    std::vector<ContentRecordDigest> hashRecords(std::string_view json, const std::vector<ContentRecordSpan>& records);
+    bool parseRecords(std::string_view json, const std::vector<ContentRecordSpan>& records,
+                      const std::vector<size_t>& selected, ContentPatch& parsed);
+    void apply(ContentPatch&& parsed);
+    void streamFromJson(std::string_view json);
+    void loadRecord(ContentSection section, const SimpleJsonValue& entry);
+    void store(TerrainTypeDefinition&& def);
+    void store(AbilityDefinition&& def);
+    void store(ItemDefinition&& def);
+    void store(EntityDefinition&& def);
+    void store(MapDefinition&& def);
+
+    static uint64_t digestKey(const ContentRecordDigest& digest);
+    static void readName(const SimpleJsonValue& value, Symbol id, std::string& name);
+    static void readSymbols(const SimpleJsonValue& value, std::vector<Symbol>& symbols);
+    static void readPoints(const SimpleJsonValue& value, std::vector<SDL_Point>& points);
+    static void readTerrainRows(const SimpleJsonValue& value, std::vector<std::vector<Symbol>>& rows);
+    static EntityKind parseEntityKind(std::string_view value);
+    static EntityFaction parseFaction(std::string_view value);
+    static AbilityTargetType parseAbilityTarget(std::string_view value);
+    static AbilityEffectType parseEffectType(std::string_view value);
+    static GameModeType parseGameMode(std::string_view value);
+    static ObjectiveType parseObjectiveType(std::string_view value);
+    static TileSpecialType parseSpecialType(std::string_view value);
+    // Portal targets are written as "x,y".
+    static bool parsePortalTarget(std::string_view value, int& x, int& y);
 };
 
 #endif
@@ -0,0 +1,385 @@
+#include "HierarchicalPathfinder.h"
+#include "Map.h"
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <queue>
+
+namespace {
+// Border runs shorter than this get one entrance in the middle, longer
+// ones one at each end.
+const int kLongEntrance = 6;
+const uint32_t kNoParent = 0xFFFFFFFFu;
+
+using QueueEntry = std::pair<int, uint32_t>;
+using MinQueue = std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>>;
+
+int manhattan(const SDL_Point& a, const SDL_Point& b) {
+    return std::abs(a.x - b.x) + std::abs(a.y - b.y);
+}
+}
+
+HierarchicalPathfinder::HierarchicalPathfinder()
+    : map(nullptr), width(0), height(0), clustersWide(0), clustersHigh(0), localGeneration(0), nodeGeneration(0) {}
+
+void HierarchicalPathfinder::clear() {
+    map = nullptr;
+    width = 0;
+    height = 0;
+    clustersWide = 0;
+    clustersHigh = 0;
+    nodes.clear();
+    edges.clear();
+    clusterNodes.clear();
+    nodeAtTile.clear();
+    tileCosts.clear();
+}
+
+void HierarchicalPathfinder::build(const Map& source) {
+    clear();
+    map = &source;
+    width = source.getWidth();
+    height = source.getHeight();
+    tileCosts.assign(static_cast<size_t>(width) * height, 0);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            if (!source.blocksMovement(x, y)) {
+                tileCosts[static_cast<size_t>(y) * width + x] =
+                    static_cast<uint8_t>(std::min(255, source.getMovementCost(x, y)));
+            }
+        }
+    }
+    clustersWide = (width + kClusterSize - 1) / kClusterSize;
+    clustersHigh = (height + kClusterSize - 1) / kClusterSize;
+    clusterNodes.resize(static_cast<size_t>(clustersWide) * clustersHigh);
+    localCost.assign(kClusterSize * kClusterSize, 0);
+    localParent.assign(kClusterSize * kClusterSize, -1);
+    localStamp.assign(kClusterSize * kClusterSize, 0);
+    localGeneration = 0;
+
+    for (int cy = 0; cy < clustersHigh; ++cy) {
+        for (int cx = 0; cx < clustersWide; ++cx) {
+            if (cx + 1 < clustersWide) {
+                const int top = cy * kClusterSize;
+                addEntrances((cx + 1) * kClusterSize - 1, top, true, std::min(kClusterSize, height - top));
+            }
+            if (cy + 1 < clustersHigh) {
+                const int left = cx * kClusterSize;
+                addEntrances(left, (cy + 1) * kClusterSize - 1, false, std::min(kClusterSize, width - left));
+            }
+        }
+    }
+
+    for (uint32_t cluster = 0; cluster < clusterNodes.size(); ++cluster) {
+        const SDL_Rect bounds = clusterBounds(cluster);
+        for (uint32_t from : clusterNodes[cluster]) {
+            costsInCluster(nodes[from].tile, false);
+            for (uint32_t to : clusterNodes[cluster]) {
+                const SDL_Point& tile = nodes[to].tile;
+                const int cost = clusterCosts[(tile.y - bounds.y) * bounds.w + (tile.x - bounds.x)];
+                if (to != from && cost >= 0) {
+                    edges[from].push_back({to, cost});
+                }
+            }
+        }
+    }
+    nodeCost.assign(nodes.size() + 2, 0);
+    nodeParent.assign(nodes.size() + 2, kNoParent);
+    nodeStamp.assign(nodes.size() + 2, 0);
+    nodeGeneration = 0;
+}
+
+size_t HierarchicalPathfinder::getEdgeCount() const {
+    size_t total = 0;
+    for (const auto& list : edges) {
+        total += list.size();
+    }
+    return total;
+}
+
+uint32_t HierarchicalPathfinder::clusterOf(int x, int y) const {
+    return static_cast<uint32_t>((y / kClusterSize) * clustersWide + x / kClusterSize);
+}
+
+SDL_Rect HierarchicalPathfinder::clusterBounds(uint32_t cluster) const {
+    const int left = static_cast<int>(cluster % clustersWide) * kClusterSize;
+    const int top = static_cast<int>(cluster / clustersWide) * kClusterSize;
+    return {left, top, std::min(kClusterSize, width - left), std::min(kClusterSize, height - top)};
+}
+
+uint32_t HierarchicalPathfinder::addNode(int x, int y) {
+    const uint32_t key = static_cast<uint32_t>(y * width + x);
+    auto it = nodeAtTile.find(key);
+    if (it != nodeAtTile.end()) {
+        return it->second;
+    }
+    const uint32_t id = static_cast<uint32_t>(nodes.size());
+    const uint32_t cluster = clusterOf(x, y);
+    nodes.push_back({{x, y}, cluster});
+    edges.emplace_back();
+    clusterNodes[cluster].push_back(id);
+    nodeAtTile.emplace(key, id);
+    return id;
+}
+
+void HierarchicalPathfinder::addEntrances(int x, int y, bool vertical, int length) {
+    auto sideA = [&](int i) { return vertical ? SDL_Point{x, y + i} : SDL_Point{x + i, y}; };
+    auto sideB = [&](int i) { return vertical ? SDL_Point{x + 1, y + i} : SDL_Point{x + i, y + 1}; };
+    auto link = [&](int i) {
+        const SDL_Point a = sideA(i);
+        const SDL_Point b = sideB(i);
+        const uint32_t nodeA = addNode(a.x, a.y);
+        const uint32_t nodeB = addNode(b.x, b.y);
+        edges[nodeA].push_back({nodeB, costAt(b.x, b.y)});
+        edges[nodeB].push_back({nodeA, costAt(a.x, a.y)});
+    };
+    int runStart = -1;
+    for (int i = 0; i <= length; ++i) {
+        bool open = false;
+        if (i < length) {
+            const SDL_Point a = sideA(i);
+            const SDL_Point b = sideB(i);
+            open = costAt(a.x, a.y) > 0 && costAt(b.x, b.y) > 0;
+        }
+        if (open && runStart < 0) {
+            runStart = i;
+        } else if (!open && runStart >= 0) {
+            if (i - runStart < kLongEntrance) {
+                link(runStart + (i - runStart) / 2);
+            } else {
+                link(runStart);
+                link(i - 1);
+            }
+            runStart = -1;
+        }
+    }
+}
+
+void HierarchicalPathfinder::costsInCluster(const SDL_Point& origin, bool reverse) const {
+    const SDL_Rect bounds = clusterBounds(clusterOf(origin.x, origin.y));
+    clusterCosts.assign(static_cast<size_t>(bounds.w) * bounds.h, -1);
+    const uint32_t first = static_cast<uint32_t>((origin.y - bounds.y) * bounds.w + (origin.x - bounds.x));
+    clusterCosts[first] = 0;
+    // Dial's buckets, as in MovementField; the last bucket in use bounds the
+    // walk instead of a budget.
+    if (buckets.empty()) {
+        buckets.resize(1);
+    }
+    buckets[0].push_back(first);
+    int lastCost = 0;
+    const int dirs[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+    for (int cost = 0; cost <= lastCost; ++cost) {
+        for (size_t i = 0; i < buckets[cost].size(); ++i) {
+            const uint32_t cell = buckets[cost][i];
+            if (clusterCosts[cell] != cost) {
+                continue;
+            }
+            const int x = bounds.x + static_cast<int>(cell % bounds.w);
+            const int y = bounds.y + static_cast<int>(cell / bounds.w);
+            const int leaveCost = reverse ? costAt(x, y) : 0;
+            for (const auto& dir : dirs) {
+                const int nx = x + dir[0];
+                const int ny = y + dir[1];
+                if (nx < bounds.x || ny < bounds.y || nx >= bounds.x + bounds.w || ny >= bounds.y + bounds.h ||
+                    costAt(nx, ny) == 0) {
+                    continue;
+                }
+                // Forward costs pay for the tile entered; reverse costs pay
+                // for the tile being left, which is the one entered going
+                // forward.
+                const int next = cost + (reverse ? leaveCost : costAt(nx, ny));
+                const uint32_t neighbor = static_cast<uint32_t>((ny - bounds.y) * bounds.w + (nx - bounds.x));
+                if (clusterCosts[neighbor] < 0 || next < clusterCosts[neighbor]) {
+                    clusterCosts[neighbor] = next;
+                    if (buckets.size() <= static_cast<size_t>(next)) {
+                        buckets.resize(next + 1);
+                    }
+                    buckets[next].push_back(neighbor);
+                    lastCost = std::max(lastCost, next);
+                }
+            }
+        }
+        buckets[cost].clear();
+    }
+}
+
+bool HierarchicalPathfinder::pathInCluster(const SDL_Point& from, const SDL_Point& to, const BitBoard* avoid,
+                                           std::vector<SDL_Point>& path) const {
+    if (from.x == to.x && from.y == to.y) {
+        return true;
+    }
+    const SDL_Rect bounds = clusterBounds(clusterOf(from.x, from.y));
+    if (++localGeneration == 0) {
+        std::fill(localStamp.begin(), localStamp.end(), 0);
+        localGeneration = 1;
+    }
+    auto local = [&](int x, int y) { return static_cast<uint32_t>((y - bounds.y) * kClusterSize + (x - bounds.x)); };
+    const uint32_t first = local(from.x, from.y);
+    const uint32_t target = local(to.x, to.y);
+    localStamp[first] = localGeneration;
+    localCost[first] = 0;
+    localParent[first] = -1;
+    MinQueue open;
+    open.push({manhattan(from, to), first});
+    const int dirs[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+    while (!open.empty()) {
+        const uint32_t cell = open.top().second;
+        const int priority = open.top().first;
+        open.pop();
+        const int x = bounds.x + static_cast<int>(cell % kClusterSize);
+        const int y = bounds.y + static_cast<int>(cell / kClusterSize);
+        if (priority != localCost[cell] + manhattan({x, y}, to)) {
+            continue;
+        }
+        if (cell == target) {
+            const size_t end = path.size();
+            for (int at = static_cast<int>(target); at != static_cast<int>(first); at = localParent[at]) {
+                path.push_back({bounds.x + at % kClusterSize, bounds.y + at / kClusterSize});
+            }
+            std::reverse(path.begin() + end, path.end());
+            return true;
+        }
+        for (const auto& dir : dirs) {
+            const int nx = x + dir[0];
+            const int ny = y + dir[1];
+            if (nx < bounds.x || ny < bounds.y || nx >= bounds.x + bounds.w || ny >= bounds.y + bounds.h ||
+                costAt(nx, ny) == 0) {
+                continue;
+            }
+            if (avoid && avoid->test(nx, ny) && !(nx == to.x && ny == to.y)) {
+                continue;
+            }
+            const uint32_t neighbor = local(nx, ny);
+            const int next = localCost[cell] + costAt(nx, ny);
+            if (localStamp[neighbor] != localGeneration || next < localCost[neighbor]) {
+                localStamp[neighbor] = localGeneration;
+                localCost[neighbor] = next;
+                localParent[neighbor] = static_cast<int>(cell);
+                open.push({next + manhattan({nx, ny}, to), neighbor});
+            }
+        }
+    }
+    return false;
+}
+
+bool HierarchicalPathfinder::searchAbstract(const SDL_Point& start, const SDL_Point& goal,
+                                            std::vector<SDL_Point>& waypoints) const {
+    const uint32_t startId = static_cast<uint32_t>(nodes.size());
+    const uint32_t goalId = startId + 1;
+    const uint32_t goalCluster = clusterOf(goal.x, goal.y);
+    const SDL_Rect goalBounds = clusterBounds(goalCluster);
+
+    // Costs from each goal-cluster node to the goal.
+    costsInCluster(goal, true);
+    std::vector<Edge> toGoal;
+    for (uint32_t id : clusterNodes[goalCluster]) {
+        const SDL_Point& tile = nodes[id].tile;
+        const int cost = clusterCosts[(tile.y - goalBounds.y) * goalBounds.w + (tile.x - goalBounds.x)];
+        if (cost >= 0) {
+            toGoal.push_back({id, cost});
+        }
+    }
+    const uint32_t startCluster = clusterOf(start.x, start.y);
+    const SDL_Rect startBounds = clusterBounds(startCluster);
+    costsInCluster(start, false);
+    std::vector<Edge> fromStart;
+    for (uint32_t id : clusterNodes[startCluster]) {
+        const SDL_Point& tile = nodes[id].tile;
+        const int cost = clusterCosts[(tile.y - startBounds.y) * startBounds.w + (tile.x - startBounds.x)];
+        if (cost >= 0) {
+            fromStart.push_back({id, cost});
+        }
+    }
+    if (startCluster == goalCluster) {
+        const int direct = clusterCosts[(goal.y - startBounds.y) * startBounds.w + (goal.x - startBounds.x)];
+        if (direct >= 0) {
+            fromStart.push_back({goalId, direct});
+        }
+    }
+
+    if (++nodeGeneration == 0) {
+        std::fill(nodeStamp.begin(), nodeStamp.end(), 0);
+        nodeGeneration = 1;
+    }
+    auto tileOf = [&](uint32_t id) { return id == startId ? start : id == goalId ? goal : nodes[id].tile; };
+    MinQueue open;
+    nodeStamp[startId] = nodeGeneration;
+    nodeCost[startId] = 0;
+    nodeParent[startId] = kNoParent;
+    open.push({manhattan(start, goal), startId});
+    auto relax = [&](uint32_t from, const Edge& edge) {
+        const int next = nodeCost[from] + edge.cost;
+        if (nodeStamp[edge.to] != nodeGeneration || next < nodeCost[edge.to]) {
+            nodeStamp[edge.to] = nodeGeneration;
+            nodeCost[edge.to] = next;
+            nodeParent[edge.to] = from;
+            open.push({next + manhattan(tileOf(edge.to), goal), edge.to});
+        }
+    };
+    while (!open.empty()) {
+        const QueueEntry entry = open.top();
+        open.pop();
+        const uint32_t id = entry.second;
+        if (entry.first != nodeCost[id] + manhattan(tileOf(id), goal)) {
+            continue;
+        }
+        if (id == goalId) {
+            for (uint32_t at = goalId; at != startId; at = nodeParent[at]) {
+                waypoints.push_back(tileOf(at));
+            }
+            std::reverse(waypoints.begin(), waypoints.end());
+            return true;
+        }
+        if (id == startId) {
+            for (const Edge& edge : fromStart) {
+                relax(id, edge);
+            }
+            continue;
+        }
+        for (const Edge& edge : edges[id]) {
+            relax(id, edge);
+        }
+        if (nodes[id].cluster == goalCluster) {
+            for (const Edge& link : toGoal) {
+                if (link.to == id) {
+                    relax(id, {goalId, link.cost});
+                }
+            }
+        }
+    }
+    return false;
+}
+
+bool HierarchicalPathfinder::findPath(const SDL_Point& start, const SDL_Point& goal, std::vector<SDL_Point>& path,
+                                      const BitBoard* avoid, int maxCost) const {
+    path.clear();
+    if (!map || !map->isInside(start.x, start.y) || !map->isInside(goal.x, goal.y) ||
+        costAt(goal.x, goal.y) == 0) {
+        return false;
+    }
+    if (start.x == goal.x && start.y == goal.y) {
+        return true;
+    }
+    std::vector<SDL_Point> waypoints;
+    if (!searchAbstract(start, goal, waypoints)) {
+        return false;
+    }
+    SDL_Point from = start;
+    int spent = 0;
+    for (const SDL_Point& waypoint : waypoints) {
+        const size_t before = path.size();
+        if (manhattan(from, waypoint) == 1 && clusterOf(from.x, from.y) != clusterOf(waypoint.x, waypoint.y)) {
+            path.push_back(waypoint);
+        } else if (!pathInCluster(from, waypoint, avoid, path) && !(avoid && pathInCluster(from, waypoint, nullptr, path))) {
+            return !path.empty();
+        }
+        for (size_t i = before; i < path.size(); ++i) {
+            spent += costAt(path[i].x, path[i].y);
+        }
+        from = waypoint;
+        if (maxCost > 0 && spent > maxCost) {
+            break;
+        }
+    }
+    return true;
+}
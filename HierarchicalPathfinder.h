@@ -0,0 +1,91 @@
+#ifndef HIERARCHICALPATHFINDER_H
+#define HIERARCHICALPATHFINDER_H
+
+#include <SDL2/SDL.h>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "BitBoard.h"
+
+class Map;
+
+// HPA*: the map is cut into square clusters, and every passable stretch of
+// a shared cluster border becomes one or two entrances. Entrance tiles are
+// the nodes of an abstract graph whose edges are the cheapest paths inside
+// one cluster, or a single step across a border. A query links start and
+// goal into their clusters, searches the small graph, and expands it into
+// tiles only as far as the caller needs.
+//
+// Only terrain is baked into the graph, together with a byte per tile of
+// movement cost so searches skip the chunk lookups. Units are avoided while
+// expanding when possible, since they move every turn.
+class HierarchicalPathfinder {
+public:
+    static constexpr int kClusterSize = 32;
+
+    HierarchicalPathfinder();
+
+    void build(const Map& map);
+    void clear();
+
+    // Fills `path` with the tiles after start, ending at goal or once their
+    // movement cost exceeds maxCost (0 means no limit). Tiles set in `avoid`
+    // are routed around where the cluster allows; the goal is always allowed.
+    bool findPath(const SDL_Point& start, const SDL_Point& goal, std::vector<SDL_Point>& path,
+                  const BitBoard* avoid = nullptr, int maxCost = 0) const;
+
+    size_t getNodeCount() const { return nodes.size(); }
+    size_t getEdgeCount() const;
+
+private:
+    struct Edge {
+        uint32_t to;
+        int cost;
+    };
+
+    struct Node {
+        SDL_Point tile;
+        uint32_t cluster;
+    };
+
+    const Map* map;
+    int width;
+    int height;
+    int clustersWide;
+    int clustersHigh;
+    std::vector<Node> nodes;
+    std::vector<std::vector<Edge>> edges;
+    std::vector<std::vector<uint32_t>> clusterNodes;
+    std::unordered_map<uint32_t, uint32_t> nodeAtTile;
+    // Movement cost per tile, 0 where movement is blocked.
+    std::vector<uint8_t> tileCosts;
+
+    // Search scratch, reused between queries; stamps avoid clearing it.
+    mutable std::vector<int> localCost;
+    mutable std::vector<int> localParent;
+    mutable std::vector<uint32_t> localStamp;
+    mutable uint32_t localGeneration;
+    mutable std::vector<int> nodeCost;
+    mutable std::vector<uint32_t> nodeParent;
+    mutable std::vector<uint32_t> nodeStamp;
+    mutable uint32_t nodeGeneration;
+    mutable std::vector<int> clusterCosts;
+    mutable std::vector<std::vector<uint32_t>> buckets;
+
+    uint32_t clusterOf(int x, int y) const;
+    SDL_Rect clusterBounds(uint32_t cluster) const;
+    int costAt(int x, int y) const { return tileCosts[static_cast<size_t>(y) * width + x]; }
+    uint32_t addNode(int x, int y);
+    // Scans `length` tile pairs along a border starting at (x, y): pairs are
+    // (x, y + i) and (x + 1, y + i) for a vertical border, (x + i, y) and
+    // (x + i, y + 1) otherwise.
+    void addEntrances(int x, int y, bool vertical, int length);
+    // Cheapest costs from origin to every tile of its cluster, written to
+    // clusterCosts; `reverse` gives costs from each tile to origin instead.
+    void costsInCluster(const SDL_Point& origin, bool reverse) const;
+    bool pathInCluster(const SDL_Point& from, const SDL_Point& to, const BitBoard* avoid,
+                       std::vector<SDL_Point>& path) const;
+    bool searchAbstract(const SDL_Point& start, const SDL_Point& goal, std::vector<SDL_Point>& waypoints) const;
+};
+
+#endif
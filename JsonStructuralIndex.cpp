@@ -0,0 +1,295 @@
+#include "JsonStructuralIndex.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define JSON_INDEX_X86 1
+#endif
+
+namespace {
+const size_t kBlockSize = 64;
+const size_t kWindowBlocks = 64;
+const uint64_t kEvenBits = 0x5555555555555555ULL;
+
+struct BlockMasks {
+    uint64_t quote;
+    uint64_t backslash;
+    uint64_t op;
+    uint64_t whitespace;
+};
+
+struct ScanState {
+    uint64_t prevEscaped;
+    uint64_t prevInString;
+    uint64_t prevScalar;
+};
+
+uint64_t prefixXor(uint64_t bits) {
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+// Turns one block's character masks into positions at `out`. Inlined into
+// each kernel so popcount and ctz compile for that kernel's target.
+__attribute__((always_inline)) inline size_t flattenBlock(const BlockMasks& block, ScanState& state,
+                                                          size_t base, size_t* out) {
+    // A backslash escapes the next character; in a run of backslashes
+    // they pair off, so only odd-length runs escape what follows.
+    uint64_t backslash = block.backslash & ~state.prevEscaped;
+    uint64_t followsEscape = (backslash << 1) | state.prevEscaped;
+    uint64_t oddStarts = backslash & ~kEvenBits & ~followsEscape;
+    uint64_t evenStarts = 0;
+    state.prevEscaped = __builtin_add_overflow(oddStarts, backslash, &evenStarts) ? 1 : 0;
+    uint64_t escaped = (kEvenBits ^ (evenStarts << 1)) & followsEscape;
+
+    uint64_t quote = block.quote & ~escaped;
+    // Set from an opening quote up to, not including, its closing quote.
+    uint64_t inString = prefixXor(quote) ^ state.prevInString;
+    state.prevInString = static_cast<uint64_t>(static_cast<int64_t>(inString) >> 63);
+
+    uint64_t scalar = ~(block.op | block.whitespace | quote);
+    uint64_t followsScalar = (scalar << 1) | state.prevScalar;
+    state.prevScalar = scalar >> 63;
+
+    uint64_t found = ((block.op | (scalar & ~followsScalar)) & ~inString) | quote;
+    // Writes eight positions at a time without checking for the end of the
+    // mask; the caller's buffer has room for the overshoot.
+    size_t foundCount = static_cast<size_t>(__builtin_popcountll(found));
+    for (size_t written = 0; written < foundCount; written += 8) {
+        for (int i = 0; i < 8; ++i) {
+            out[written + i] = base + static_cast<size_t>(__builtin_ctzll(found | (uint64_t(1) << 63)));
+            found &= found - 1;
+        }
+    }
+    return foundCount;
+}
+
+// Each kernel indexes `blocks` full blocks starting at input offset `base`
+// and returns the number of positions written.
+using IndexBlocks = size_t (*)(const unsigned char* data, size_t blocks, size_t base, ScanState& state, size_t* out);
+
+// Portable fallback; also kept on x86 so it can be compared with the
+// vector kernels.
+enum CharClass : uint8_t {
+    kQuote = 1,
+    kBackslash = 2,
+    kOp = 4,
+    kWhitespace = 8
+};
+
+struct CharClassTable {
+    uint8_t classes[256];
+
+    CharClassTable() : classes() {
+        classes[static_cast<unsigned char>('"')] = kQuote;
+        classes[static_cast<unsigned char>('\\')] = kBackslash;
+        for (char c : {'{', '}', '[', ']', ':', ','}) {
+            classes[static_cast<unsigned char>(c)] = kOp;
+        }
+        // Same set as std::isspace in the C locale, which the parser uses.
+        for (char c : {' ', '\t', '\n', '\v', '\f', '\r'}) {
+            classes[static_cast<unsigned char>(c)] = kWhitespace;
+        }
+    }
+};
+
+size_t indexScalar(const unsigned char* data, size_t blocks, size_t base, ScanState& state, size_t* out) {
+    static const CharClassTable table;
+    ScanState local = state;
+    size_t count = 0;
+    for (size_t b = 0; b < blocks; ++b, data += kBlockSize) {
+        BlockMasks masks = {0, 0, 0, 0};
+        for (size_t i = 0; i < kBlockSize; ++i) {
+            uint8_t cls = table.classes[data[i]];
+            uint64_t bit = uint64_t(1) << i;
+            masks.quote |= (cls & kQuote) ? bit : 0;
+            masks.backslash |= (cls & kBackslash) ? bit : 0;
+            masks.op |= (cls & kOp) ? bit : 0;
+            masks.whitespace |= (cls & kWhitespace) ? bit : 0;
+        }
+        count += flattenBlock(masks, local, base + b * kBlockSize, out + count);
+    }
+    state = local;
+    return count;
+}
+
+#if defined(JSON_INDEX_X86) && defined(__SSE2__)
+size_t indexSse2(const unsigned char* data, size_t blocks, size_t base, ScanState& state, size_t* out) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i lowerCase = _mm_set1_epi8(0x20);
+    const __m128i openBrace = _mm_set1_epi8('{');
+    const __m128i closeBrace = _mm_set1_epi8('}');
+    const __m128i colon = _mm_set1_epi8(':');
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i controlSpan = _mm_set1_epi8('\r' - '\t');
+    ScanState local = state;
+    size_t count = 0;
+    for (size_t b = 0; b < blocks; ++b, data += kBlockSize) {
+        BlockMasks masks = {0, 0, 0, 0};
+        for (int part = 0; part < 4; ++part) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + part * 16));
+            // '[' and ']' are '{' and '}' without the 0x20 bit.
+            __m128i folded = _mm_or_si128(v, lowerCase);
+            __m128i op = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(folded, openBrace), _mm_cmpeq_epi8(folded, closeBrace)),
+                                      _mm_or_si128(_mm_cmpeq_epi8(v, colon), _mm_cmpeq_epi8(v, comma)));
+            __m128i fromTab = _mm_sub_epi8(v, tab);
+            __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(fromTab, controlSpan), fromTab);
+            __m128i whitespace = _mm_or_si128(control, _mm_cmpeq_epi8(v, space));
+            int shift = part * 16;
+            masks.quote |= uint64_t(uint16_t(_mm_movemask_epi8(_mm_cmpeq_epi8(v, quote)))) << shift;
+            masks.backslash |= uint64_t(uint16_t(_mm_movemask_epi8(_mm_cmpeq_epi8(v, backslash)))) << shift;
+            masks.op |= uint64_t(uint16_t(_mm_movemask_epi8(op))) << shift;
+            masks.whitespace |= uint64_t(uint16_t(_mm_movemask_epi8(whitespace))) << shift;
+        }
+        count += flattenBlock(masks, local, base + b * kBlockSize, out + count);
+    }
+    state = local;
+    return count;
+}
+#endif
+
+#if defined(JSON_INDEX_X86)
+__attribute__((target("avx2,popcnt,bmi")))
+size_t indexAvx2(const unsigned char* data, size_t blocks, size_t base, ScanState& state, size_t* out) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i lowerCase = _mm256_set1_epi8(0x20);
+    const __m256i openBrace = _mm256_set1_epi8('{');
+    const __m256i closeBrace = _mm256_set1_epi8('}');
+    const __m256i colon = _mm256_set1_epi8(':');
+    const __m256i comma = _mm256_set1_epi8(',');
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i controlSpan = _mm256_set1_epi8('\r' - '\t');
+    ScanState local = state;
+    size_t count = 0;
+    for (size_t b = 0; b < blocks; ++b, data += kBlockSize) {
+        BlockMasks masks = {0, 0, 0, 0};
+        for (int part = 0; part < 2; ++part) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + part * 32));
+            __m256i folded = _mm256_or_si256(v, lowerCase);
+            __m256i op = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(folded, openBrace), _mm256_cmpeq_epi8(folded, closeBrace)),
+                _mm256_or_si256(_mm256_cmpeq_epi8(v, colon), _mm256_cmpeq_epi8(v, comma)));
+            __m256i fromTab = _mm256_sub_epi8(v, tab);
+            __m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(fromTab, controlSpan), fromTab);
+            __m256i whitespace = _mm256_or_si256(control, _mm256_cmpeq_epi8(v, space));
+            int shift = part * 32;
+            masks.quote |= uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, quote)))) << shift;
+            masks.backslash |= uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, backslash)))) << shift;
+            masks.op |= uint64_t(uint32_t(_mm256_movemask_epi8(op))) << shift;
+            masks.whitespace |= uint64_t(uint32_t(_mm256_movemask_epi8(whitespace))) << shift;
+        }
+        count += flattenBlock(masks, local, base + b * kBlockSize, out + count);
+    }
+    state = local;
+    return count;
+}
+#endif
+
+struct Kernel {
+    IndexBlocks index;
+    const char* name;
+};
+
+// Fastest first.
+const Kernel kKernels[] = {
+#if defined(JSON_INDEX_X86)
+    {indexAvx2, "avx2"},
+#endif
+#if defined(JSON_INDEX_X86) && defined(__SSE2__)
+    {indexSse2, "sse2"},
+#endif
+    {indexScalar, "scalar"},
+};
+
+bool isSupported(const Kernel& candidate) {
+#if defined(JSON_INDEX_X86)
+    if (candidate.index == indexAvx2) {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt") && __builtin_cpu_supports("bmi");
+    }
+#endif
+    return true;
+}
+
+Kernel selectKernel() {
+    for (const Kernel& candidate : kKernels) {
+        if (isSupported(candidate)) {
+            return candidate;
+        }
+    }
+    return {indexScalar, "scalar"};
+}
+
+Kernel& kernel() {
+    static Kernel selected = selectKernel();
+    return selected;
+}
+}
+
+JsonStructuralIndex::JsonStructuralIndex() : JsonStructuralIndex(std::string_view()) {}
+
+JsonStructuralIndex::JsonStructuralIndex(std::string_view data)
+    : positions(kWindowBlocks * kBlockSize + 8) {
+    reset(data);
+}
+
+void JsonStructuralIndex::reset(std::string_view data) {
+    input = data;
+    scanned = 0;
+    count = 0;
+    cursor = 0;
+    prevEscaped = 0;
+    prevInString = 0;
+    prevScalar = 0;
+}
+
+const char* JsonStructuralIndex::getKernelName() {
+    return kernel().name;
+}
+
+bool JsonStructuralIndex::setKernel(const char* name) {
+    for (const Kernel& candidate : kKernels) {
+        if (std::strcmp(candidate.name, name) == 0 && isSupported(candidate)) {
+            kernel() = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool JsonStructuralIndex::indexNextWindow() {
+    if (scanned >= input.size()) {
+        return false;
+    }
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(input.data()) + scanned;
+    size_t remaining = input.size() - scanned;
+    size_t blocks = std::min(kWindowBlocks, remaining / kBlockSize);
+    ScanState state = {prevEscaped, prevInString, prevScalar};
+    cursor = 0;
+    count = kernel().index(data, blocks, scanned, state, positions.data());
+    size_t consumed = blocks * kBlockSize;
+    if (blocks < kWindowBlocks && consumed < remaining) {
+        // Pad the last partial block with spaces, which never produce a position.
+        unsigned char tail[kBlockSize];
+        std::memset(tail, ' ', sizeof(tail));
+        std::memcpy(tail, data + consumed, remaining - consumed);
+        count += kernel().index(tail, 1, scanned + consumed, state, positions.data() + count);
+        consumed = remaining;
+    }
+    prevEscaped = state.prevEscaped;
+    prevInString = state.prevInString;
+    prevScalar = state.prevScalar;
+    scanned += consumed;
+    return true;
+}
@@ -0,0 +1,54 @@
+#ifndef JSONSTRUCTURALINDEX_H
+#define JSONSTRUCTURALINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// First parser stage: classifies the input 64 bytes at a time (AVX2 or SSE2
+// when the CPU has them) and yields the positions of every structural
+// character outside strings, every unescaped quote and every start of a
+// bare scalar. Anything between two consecutive positions is whitespace or
+// the inside of a string, so the parser can jump between them instead of
+// reading each byte. Positions are produced a window at a time as the
+// parser asks for them.
+class JsonStructuralIndex {
+public:
+    JsonStructuralIndex();
+    explicit JsonStructuralIndex(std::string_view input);
+
+    void reset(std::string_view input);
+    // Position of the first indexed character at or after `position`, or
+    // the input size if there is none. `position` must not decrease
+    // between calls.
+    size_t nextAtOrAfter(size_t position) {
+        while (true) {
+            while (cursor < count) {
+                if (positions[cursor] >= position) return positions[cursor];
+                cursor++;
+            }
+            if (!indexNextWindow()) return input.size();
+        }
+    }
+
+    // Name of the block classifier in use: "avx2", "sse2" or "scalar".
+    static const char* getKernelName();
+    // Forces a classifier by name, for benchmarks. False when this build or
+    // CPU lacks it. Must not be called while any input is being indexed.
+    static bool setKernel(const char* name);
+
+private:
+    std::string_view input;
+    size_t scanned;
+    std::vector<size_t> positions;
+    size_t count;
+    size_t cursor;
+    uint64_t prevEscaped;
+    uint64_t prevInString;
+    uint64_t prevScalar;
+
+    bool indexNextWindow();
+};
+
+#endif
@@ -1,75 +1,410 @@
 #include "Map.h"
 #include <algorithm>
+#include <cstdlib>
 
-Map::Map() : width(0), height(0), tileSize(32) {}
-
-bool Map::loadFromDefinition(const MapDefinition& definition,
-                             const std::unordered_map<std::string, TerrainTypeDefinition>& terrainTypes) {
-    width = definition.width;
-    height = definition.height;
-    tiles.clear();
-    tiles.resize(height, std::vector<TileData>(width));
-
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            TileData tile;
-            std::string terrainId = "plain";
-            if (y < static_cast<int>(definition.terrainIds.size()) &&
-                x < static_cast<int>(definition.terrainIds[y].size())) {
-                terrainId = definition.terrainIds[y][x];
-            }
-            auto terrainIt = terrainTypes.find(terrainId);
-            if (terrainIt != terrainTypes.end()) {
-                tile.terrain = terrainIt->second;
-            } else {
-                tile.terrain = terrainTypes.begin()->second;
-            }
-            tiles[y][x] = tile;
-        }
+namespace {
+// Chunks this many chunks from a focus tile's chunk are kept resident.
+const int kFocusRadiusChunks = 1;
+}
+
+Map::Map()
+    : width(0),
+      height(0),
+      tileSize(32),
+      chunksWide(0),
+      chunksHigh(0),
+      plainSlot(0),
+      chunkBudget(kDefaultChunkBudgetBytes),
+      lastChunk(kNoChunk),
+      textureBytes(0),
+      frame(0),
+      texturesUnsupported(false) {}
+
+Map::~Map() {
+    releaseTextures();
+}
+
+bool Map::load(const MapDefinition& definition, std::shared_ptr<const MapTerrainSource> terrain,
+               const SymbolMap<TerrainTypeDefinition>& terrainTypes) {
+    if (!terrain) {
+        return false;
     }
+    width = std::max(0, definition.width);
+    height = std::max(0, definition.height);
+    chunksWide = (width + kChunkMask) >> kChunkShift;
+    chunksHigh = (height + kChunkMask) >> kChunkShift;
+    terrainSource = std::move(terrain);
+    buildTerrainTable(terrainTypes);
+    dropChunks();
+    chunks.resize(static_cast<size_t>(chunksWide) * chunksHigh);
+    lruPositions.resize(chunks.size());
+    releaseTextures();
+    textures.assign(chunks.size(), ChunkTexture());
+
+    specialMarkers.reset({0, 0, width, height});
+    specialTiles.clear();
+    specials.clear();
 
+    // Sorted by tile; when a tile is listed twice the later entry wins.
+    std::vector<SpecialTileDefinition> sorted;
     for (const auto& special : definition.specials) {
         if (isInside(special.x, special.y)) {
-            tiles[special.y][special.x].specialType = special.type;
-            tiles[special.y][special.x].special = special;
+            sorted.push_back(special);
+        }
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), [this](const SpecialTileDefinition& a, const SpecialTileDefinition& b) {
+        return tileIndex(a.x, a.y) < tileIndex(b.x, b.y);
+    });
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        const SpecialTileDefinition& special = sorted[i];
+        uint32_t tile = static_cast<uint32_t>(tileIndex(special.x, special.y));
+        if (special.type == TileSpecialType::None ||
+            (i + 1 < sorted.size() && tileIndex(sorted[i + 1].x, sorted[i + 1].y) == tile)) {
+            continue;
+        }
+        specialTiles.push_back(tile);
+        specials.push_back(special);
+        specialMarkers.set(special.x, special.y);
+    }
+
+    return true;
+}
+
+bool Map::loadFromDefinition(std::shared_ptr<const MapDefinition> definition,
+                             const SymbolMap<TerrainTypeDefinition>& terrainTypes) {
+    const MapDefinition& loaded = *definition;
+    return load(loaded, std::make_shared<DefinitionTerrainSource>(std::move(definition)), terrainTypes);
+}
+
+void Map::updateTerrainType(const TerrainTypeDefinition& updated) {
+    auto it = terrainSlots.find(updated.id);
+    if (it == terrainSlots.end()) return;
+    const uint8_t slot = it->second;
+    terrainTable[slot] = updated;
+    invalidateTextures();
+    for (const auto& chunk : chunks) {
+        if (!chunk) continue;
+        for (int y = 0; y < kChunkSize; ++y) {
+            for (int x = 0; x < kChunkSize; ++x) {
+                if (chunk->terrain[(y << kChunkShift) | x] == slot) {
+                    setBlockers(*chunk, x, y, slot);
+                }
+            }
         }
     }
+}
 
+bool Map::patchTerrain(std::shared_ptr<const MapDefinition> definition,
+                       const SymbolMap<TerrainTypeDefinition>& terrainTypes) {
+    if (definition->width != width || definition->height != height) {
+        return false;
+    }
+    terrainSource = std::make_shared<DefinitionTerrainSource>(std::move(definition));
+    buildTerrainTable(terrainTypes);
+    dropChunks();
+    invalidateTextures();
     return true;
 }
 
-void Map::drawMap(SDL_Renderer* renderer, bool drawGrid) const {
-    SDL_Rect rect = {0, 0, tileSize, tileSize};
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            rect.x = x * tileSize;
-            rect.y = y * tileSize;
-            const TileData& tile = tiles[y][x];
-            SDL_SetRenderDrawColor(renderer, tile.terrain.color.r, tile.terrain.color.g, tile.terrain.color.b, 255);
-            SDL_RenderFillRect(renderer, &rect);
-            if (tile.specialType != TileSpecialType::None) {
-                SDL_SetRenderDrawColor(renderer, 255, 255, 255, 60);
-                SDL_RenderFillRect(renderer, &rect);
+void Map::setChunkBudget(size_t bytes) {
+    chunkBudget = bytes;
+    evictChunks(kNoChunk);
+    lastChunk = kNoChunk;
+}
+
+void Map::setFocus(const std::vector<SDL_Point>& tiles) {
+    focusChunks.clear();
+    for (const SDL_Point& tile : tiles) {
+        if (isInside(tile.x, tile.y)) {
+            focusChunks.push_back({tile.x >> kChunkShift, tile.y >> kChunkShift});
+        }
+    }
+}
+
+// Missing cells read as "plain" and unknown ids as an arbitrary known
+// terrain, as the loader has always done. Only the first 256 terrain types
+// get a slot; later ones fall back the same way.
+void Map::buildTerrainTable(const SymbolMap<TerrainTypeDefinition>& terrainTypes) {
+    static const Symbol plainId = internSymbol("plain");
+    terrainTable.clear();
+    terrainSlots.clear();
+    // Slots follow the ids' names, not the hash map, so they do not change
+    // with the order symbols were interned in.
+    std::vector<const TerrainTypeDefinition*> sorted;
+    sorted.reserve(terrainTypes.size());
+    for (const auto& entry : terrainTypes) {
+        sorted.push_back(&entry.second);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const TerrainTypeDefinition* a, const TerrainTypeDefinition* b) {
+        return symbolName(a->id) < symbolName(b->id);
+    });
+    for (const TerrainTypeDefinition* type : sorted) {
+        if (terrainTable.size() == kMaxTerrainTypes) break;
+        terrainSlots[type->id] = static_cast<uint8_t>(terrainTable.size());
+        terrainTable.push_back(*type);
+    }
+    if (terrainTable.empty()) {
+        terrainTable.push_back(TerrainTypeDefinition());
+    }
+    // Missing and unknown ids are drawn as plain, or as the first type by
+    // name when there is no plain terrain.
+    auto plain = terrainSlots.find(plainId);
+    plainSlot = plain != terrainSlots.end() ? plain->second : 0;
+}
+
+void Map::dropChunks() {
+    for (auto& chunk : chunks) {
+        chunk.reset();
+    }
+    lru.clear();
+    lastChunk = kNoChunk;
+}
+
+const Map::Chunk& Map::chunkAt(int x, int y) const {
+    const uint32_t index = static_cast<uint32_t>((y >> kChunkShift) * chunksWide + (x >> kChunkShift));
+    if (index != lastChunk) {
+        if (chunks[index]) {
+            lru.splice(lru.begin(), lru, lruPositions[index]);
+        } else {
+            loadChunk(index);
+        }
+        lastChunk = index;
+    }
+    return *chunks[index];
+}
+
+void Map::loadChunk(uint32_t index) const {
+    const int originX = static_cast<int>(index % chunksWide) << kChunkShift;
+    const int originY = static_cast<int>(index / chunksWide) << kChunkShift;
+    const int chunkWidth = std::min(kChunkSize, width - originX);
+    const int chunkHeight = std::min(kChunkSize, height - originY);
+    if (!terrainSource->readTerrain(originX, originY, chunkWidth, chunkHeight, chunkIds)) {
+        chunkIds.assign(static_cast<size_t>(chunkWidth) * chunkHeight, Symbol());
+    }
+
+    std::unique_ptr<Chunk> chunk(new Chunk());
+    Symbol lastId;
+    uint8_t slot = plainSlot;
+    for (int y = 0; y < chunkHeight; ++y) {
+        for (int x = 0; x < chunkWidth; ++x) {
+            Symbol id = chunkIds[static_cast<size_t>(y) * chunkWidth + x];
+            if (id != lastId) {
+                auto it = terrainSlots.find(id);
+                slot = it != terrainSlots.end() ? it->second : plainSlot;
+                lastId = id;
+            }
+            chunk->terrain[(y << kChunkShift) | x] = slot;
+            setBlockers(*chunk, x, y, slot);
+        }
+    }
+    chunks[index] = std::move(chunk);
+    lru.push_front(index);
+    lruPositions[index] = lru.begin();
+    evictChunks(index);
+}
+
+void Map::setBlockers(Chunk& chunk, int localX, int localY, uint8_t slot) const {
+    const uint64_t bit = uint64_t(1) << localX;
+    const TerrainTypeDefinition& definition = terrainTable[slot];
+    if (definition.blocksMovement) {
+        chunk.movementBlockers[localY] |= bit;
+    } else {
+        chunk.movementBlockers[localY] &= ~bit;
+    }
+    if (definition.blocksLineOfSight) {
+        chunk.sightBlockers[localY] |= bit;
+    } else {
+        chunk.sightBlockers[localY] &= ~bit;
+    }
+}
+
+void Map::evictChunks(uint32_t keep) const {
+    auto it = lru.end();
+    while (lru.size() * sizeof(Chunk) > chunkBudget && it != lru.begin()) {
+        --it;
+        if (*it == keep || isNearFocus(*it)) {
+            continue;
+        }
+        chunks[*it].reset();
+        it = lru.erase(it);
+    }
+}
+
+bool Map::isNearFocus(uint32_t index) const {
+    const int chunkX = static_cast<int>(index % chunksWide);
+    const int chunkY = static_cast<int>(index / chunksWide);
+    for (const SDL_Point& focus : focusChunks) {
+        if (std::abs(focus.x - chunkX) <= kFocusRadiusChunks && std::abs(focus.y - chunkY) <= kFocusRadiusChunks) {
+            return true;
+        }
+    }
+    return false;
+}
+
+SDL_Rect Map::chunkBounds(uint32_t index) const {
+    const int originX = static_cast<int>(index % chunksWide) << kChunkShift;
+    const int originY = static_cast<int>(index / chunksWide) << kChunkShift;
+    return {originX, originY, std::min(kChunkSize, width - originX), std::min(kChunkSize, height - originY)};
+}
+
+void Map::drawMap(RenderBatcher& batch, const Camera& camera, bool drawGrid) const {
+    frame++;
+    const SDL_Rect visible = camera.getVisibleTiles();
+    if (visible.w <= 0 || visible.h <= 0) {
+        return;
+    }
+    const int firstChunkX = visible.x >> kChunkShift;
+    const int firstChunkY = visible.y >> kChunkShift;
+    const int lastChunkX = (visible.x + visible.w - 1) >> kChunkShift;
+    const int lastChunkY = (visible.y + visible.h - 1) >> kChunkShift;
+    for (int chunkY = firstChunkY; chunkY <= lastChunkY; ++chunkY) {
+        for (int chunkX = firstChunkX; chunkX <= lastChunkX; ++chunkX) {
+            const uint32_t index = static_cast<uint32_t>(chunkY * chunksWide + chunkX);
+            const SDL_Rect bounds = chunkBounds(index);
+            if (refreshTexture(batch, index, drawGrid)) {
+                const SDL_Rect first = camera.tileToScreen(bounds.x, bounds.y);
+                const SDL_Rect last = camera.tileToScreen(bounds.x + bounds.w - 1, bounds.y + bounds.h - 1);
+                SDL_Rect target = {first.x, first.y, last.x + last.w - first.x, last.y + last.h - first.y};
+                SDL_RenderCopy(batch.getRenderer(), textures[index].texture, nullptr, &target);
+                batch.countDrawCalls(1);
+                continue;
             }
-            if (drawGrid) {
-                SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-                SDL_RenderDrawRect(renderer, &rect);
+            const int startX = std::max(bounds.x, visible.x);
+            const int startY = std::max(bounds.y, visible.y);
+            const int endX = std::min(bounds.x + bounds.w, visible.x + visible.w);
+            const int endY = std::min(bounds.y + bounds.h, visible.y + visible.h);
+            for (int y = startY; y < endY; ++y) {
+                for (int x = startX; x < endX; ++x) {
+                    drawTile(batch, x, y, camera.tileToScreen(x, y), drawGrid);
+                }
             }
         }
     }
 }
 
-void Map::drawHighlights(SDL_Renderer* renderer, const std::vector<SDL_Point>& cells, const SDL_Color& color) const {
-    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
-    SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
+void Map::drawTile(RenderBatcher& batch, int x, int y, const SDL_Rect& rect, bool drawGrid) const {
+    const SDL_Color& color = terrainAt(x, y).color;
+    batch.fillRect(RenderLayer::Terrain, rect, SDL_Color{color.r, color.g, color.b, 255});
+    if (specialMarkers.test(x, y)) {
+        batch.fillRect(RenderLayer::TerrainOverlay, rect, SDL_Color{255, 255, 255, 60});
+    }
+    if (drawGrid) {
+        batch.outlineRect(RenderLayer::Grid, rect, SDL_Color{0, 0, 0, 255});
+    }
+}
+
+// Brings a chunk's texture up to date, creating it on first use. Returns
+// false when render targets are unavailable, or the budget is taken by
+// chunks already drawn this frame, and the caller must draw tiles.
+bool Map::refreshTexture(RenderBatcher& batch, uint32_t index, bool drawGrid) const {
+    SDL_Renderer* renderer = batch.getRenderer();
+    if (texturesUnsupported) {
+        return false;
+    }
+    ChunkTexture& entry = textures[index];
+    if (entry.texture && entry.grid != drawGrid) {
+        destroyTexture(index);
+    }
+    const SDL_Rect bounds = chunkBounds(index);
+    const bool created = !entry.texture;
+    if (created) {
+        if (!SDL_RenderTargetSupported(renderer)) {
+            texturesUnsupported = true;
+            return false;
+        }
+        const size_t bytes = static_cast<size_t>(bounds.w) * bounds.h * tileSize * tileSize * 4;
+        while (textureBytes + bytes > kTextureBudgetBytes && !textureLru.empty() &&
+               textures[textureLru.back()].lastFrame != frame) {
+            destroyTexture(textureLru.back());
+        }
+        if (textureBytes + bytes > kTextureBudgetBytes && !textureLru.empty()) {
+            return false;
+        }
+        entry.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET,
+                                          bounds.w * tileSize, bounds.h * tileSize);
+        if (!entry.texture) {
+            texturesUnsupported = true;
+            return false;
+        }
+        SDL_SetTextureBlendMode(entry.texture, SDL_BLENDMODE_NONE);
+        entry.grid = drawGrid;
+        entry.dirtyTiles.clear();
+        textureLru.push_front(index);
+        entry.lruPosition = textureLru.begin();
+        textureBytes += bytes;
+    } else {
+        textureLru.splice(textureLru.begin(), textureLru, entry.lruPosition);
+    }
+    entry.lastFrame = frame;
+    if (!created && entry.dirtyTiles.empty()) {
+        return true;
+    }
+
+    // Quads already queued belong to the current target.
+    batch.flush();
+    SDL_Texture* previous = SDL_GetRenderTarget(renderer);
+    SDL_SetRenderTarget(renderer, entry.texture);
+    if (created) {
+        for (int y = bounds.y; y < bounds.y + bounds.h; ++y) {
+            for (int x = bounds.x; x < bounds.x + bounds.w; ++x) {
+                drawTile(batch, x, y, textureRect(bounds, x, y), drawGrid);
+            }
+        }
+    } else {
+        for (const SDL_Point& tile : entry.dirtyTiles) {
+            drawTile(batch, tile.x, tile.y, textureRect(bounds, tile.x, tile.y), drawGrid);
+        }
+        entry.dirtyTiles.clear();
+    }
+    batch.flush();
+    SDL_SetRenderTarget(renderer, previous);
+    return true;
+}
+
+SDL_Rect Map::textureRect(const SDL_Rect& bounds, int x, int y) const {
+    return {(x - bounds.x) * tileSize, (y - bounds.y) * tileSize, tileSize, tileSize};
+}
+
+void Map::destroyTexture(uint32_t index) const {
+    ChunkTexture& entry = textures[index];
+    if (!entry.texture) {
+        return;
+    }
+    const SDL_Rect bounds = chunkBounds(index);
+    SDL_DestroyTexture(entry.texture);
+    entry.texture = nullptr;
+    entry.dirtyTiles.clear();
+    textureLru.erase(entry.lruPosition);
+    textureBytes -= static_cast<size_t>(bounds.w) * bounds.h * tileSize * tileSize * 4;
+}
+
+void Map::markTileDirty(int x, int y) {
+    const uint32_t index = static_cast<uint32_t>((y >> kChunkShift) * chunksWide + (x >> kChunkShift));
+    if (textures[index].texture) {
+        textures[index].dirtyTiles.push_back({x, y});
+    }
+}
+
+void Map::invalidateTextures() {
+    for (uint32_t index = 0; index < textures.size(); ++index) {
+        destroyTexture(index);
+    }
+}
+
+void Map::releaseTextures() {
+    invalidateTextures();
+    texturesUnsupported = false;
+}
+
+void Map::drawHighlights(RenderBatcher& batch, const Camera& camera, const std::vector<SDL_Point>& cells,
+                         const SDL_Color& color) const {
+    const SDL_Rect visible = camera.getVisibleTiles();
     for (const SDL_Point& cell : cells) {
-        if (!isInside(cell.x, cell.y)) {
+        if (!SDL_PointInRect(&cell, &visible)) {
             continue;
         }
-        SDL_Rect rect = {cell.x * tileSize, cell.y * tileSize, tileSize, tileSize};
-        SDL_RenderFillRect(renderer, &rect);
+        batch.fillRect(RenderLayer::Highlights, camera.tileToScreen(cell.x, cell.y), color);
     }
-    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
 }
 
 bool Map::isInside(int x, int y) const {
@@ -78,40 +413,86 @@ bool Map::isInside(int x, int y) const {
 
 int Map::getMovementCost(int x, int y) const {
     if (!isInside(x, y)) return 9999;
-    return std::max(1, tiles[y][x].terrain.movementCost);
+    return std::max(1, terrainAt(x, y).movementCost);
 }
 
 int Map::getDefenseModifier(int x, int y) const {
     if (!isInside(x, y)) return 0;
-    return tiles[y][x].terrain.defenseModifier;
+    return terrainAt(x, y).defenseModifier;
 }
 
 int Map::getDodgeModifier(int x, int y) const {
     if (!isInside(x, y)) return 0;
-    return tiles[y][x].terrain.dodgeModifier;
+    return terrainAt(x, y).dodgeModifier;
 }
 
 bool Map::blocksMovement(int x, int y) const {
     if (!isInside(x, y)) return true;
-    return tiles[y][x].terrain.blocksMovement;
+    return (chunkAt(x, y).movementBlockers[y & kChunkMask] >> (x & kChunkMask)) & 1;
 }
 
 bool Map::blocksLineOfSight(int x, int y) const {
     if (!isInside(x, y)) return true;
-    return tiles[y][x].terrain.blocksLineOfSight;
+    return (chunkAt(x, y).sightBlockers[y & kChunkMask] >> (x & kChunkMask)) & 1;
+}
+
+void Map::fillMovementBlockers(BitBoard& board) const {
+    fillBlockers(board, &Chunk::movementBlockers);
+}
+
+void Map::fillSightBlockers(BitBoard& board) const {
+    fillBlockers(board, &Chunk::sightBlockers);
+}
+
+// Chunk rows are already one word each, so a board row takes one shifted
+// OR per chunk it overlaps.
+void Map::fillBlockers(BitBoard& board, const uint64_t (Chunk::*plane)[kChunkSize]) const {
+    const SDL_Rect& area = board.getArea();
+    const int top = std::max(0, area.y);
+    const int bottom = std::min(height, area.y + area.h);
+    const int firstChunkX = std::max(0, area.x) >> kChunkShift;
+    const int endX = std::min(width, area.x + area.w);
+    if (endX <= 0) {
+        return;
+    }
+    const int lastChunkX = (endX - 1) >> kChunkShift;
+    for (int y = top; y < bottom; ++y) {
+        for (int chunkX = firstChunkX; chunkX <= lastChunkX; ++chunkX) {
+            const Chunk& chunk = chunkAt(chunkX << kChunkShift, y);
+            board.orWord(chunkX << kChunkShift, y, (chunk.*plane)[y & kChunkMask]);
+        }
+    }
+}
+
+void Map::fillSpecials(BitBoard& board) const {
+    board |= specialMarkers;
+}
+
+const SpecialTileDefinition* Map::findSpecial(int x, int y) const {
+    if (!isInside(x, y)) return nullptr;
+    if (!specialMarkers.test(x, y)) return nullptr;
+    size_t tile = tileIndex(x, y);
+    auto it = std::lower_bound(specialTiles.begin(), specialTiles.end(), static_cast<uint32_t>(tile));
+    return &specials[it - specialTiles.begin()];
 }
 
 TileSpecialType Map::getSpecialType(int x, int y) const {
-    if (!isInside(x, y)) return TileSpecialType::None;
-    return tiles[y][x].specialType;
+    const SpecialTileDefinition* special = findSpecial(x, y);
+    return special ? special->type : TileSpecialType::None;
 }
 
-SpecialTileDefinition Map::getSpecialDefinition(int x, int y) const {
-    if (!isInside(x, y)) return SpecialTileDefinition();
-    return tiles[y][x].special;
+const SpecialTileDefinition& Map::getSpecialDefinition(int x, int y) const {
+    static const SpecialTileDefinition none;
+    const SpecialTileDefinition* special = findSpecial(x, y);
+    return special ? *special : none;
 }
 
 void Map::removeItemAt(int x, int y) {
-    if (!isInside(x, y)) return;
-    tiles[y][x].specialType = TileSpecialType::None;
+    if (!findSpecial(x, y)) return;
+    size_t tile = tileIndex(x, y);
+    auto it = std::lower_bound(specialTiles.begin(), specialTiles.end(), static_cast<uint32_t>(tile));
+    specials.erase(specials.begin() + (it - specialTiles.begin()));
+    specialTiles.erase(it);
+    specialMarkers.clear(x, y);
+    markTileDirty(x, y);
 }
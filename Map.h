@@ -2,25 +2,59 @@
 #define MAP_H
 
 #include <SDL2/SDL.h>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
 #include <vector>
 #include <unordered_map>
+#include "BitBoard.h"
+#include "Camera.h"
 #include "GameContent.h"
+#include "RenderBatcher.h"
 
-struct TileData {
-    TerrainTypeDefinition terrain;
-    TileSpecialType specialType = TileSpecialType::None;
-    SpecialTileDefinition special;
-};
-
+// Terrain is kept in square chunks read from a MapTerrainSource the first
+// time a tile in them is queried. Resident chunks are bounded by a byte
+// budget; when it is exceeded the least recently used chunk is dropped,
+// except for chunks around the focus tiles. Queries load chunks as needed,
+// so callers never see whether one is resident.
 class Map {
 public:
+    static constexpr int kChunkShift = 6;
+    static constexpr int kChunkSize = 1 << kChunkShift;
+    static constexpr size_t kDefaultChunkBudgetBytes = 16 * 1024 * 1024;
+
     Map();
+    ~Map();
+
+    Map(const Map&) = delete;
+    Map& operator=(const Map&) = delete;
+
+    bool load(const MapDefinition& definition, std::shared_ptr<const MapTerrainSource> terrain,
+              const SymbolMap<TerrainTypeDefinition>& terrainTypes);
+    bool loadFromDefinition(std::shared_ptr<const MapDefinition> definition,
+                            const SymbolMap<TerrainTypeDefinition>& terrainTypes);
+    // Live-reload hooks. Specials are left alone since they carry game state
+    // (collected items); patchTerrain fails if the dimensions changed.
+    void updateTerrainType(const TerrainTypeDefinition& updated);
+    bool patchTerrain(std::shared_ptr<const MapDefinition> definition,
+                      const SymbolMap<TerrainTypeDefinition>& terrainTypes);
 
-    bool loadFromDefinition(const MapDefinition& definition,
-                            const std::unordered_map<std::string, TerrainTypeDefinition>& terrainTypes);
+    void setChunkBudget(size_t bytes);
+    // Chunks within one chunk of these tiles, usually the live entities,
+    // are never evicted.
+    void setFocus(const std::vector<SDL_Point>& tiles);
+    size_t getResidentChunks() const { return lru.size(); }
 
-    void drawMap(SDL_Renderer* renderer, bool drawGrid) const;
-    void drawHighlights(SDL_Renderer* renderer, const std::vector<SDL_Point>& cells, const SDL_Color& color) const;
+    // Terrain, special markers and grid are drawn once into a texture per
+    // chunk and copied each frame; changed tiles are redrawn into it. Only
+    // chunks the camera can see are touched. Tiles drawn without a texture
+    // are queued on the batcher.
+    void drawMap(RenderBatcher& batch, const Camera& camera, bool drawGrid) const;
+    // Must be called before the renderer that drew the map is destroyed.
+    void releaseTextures();
+    void drawHighlights(RenderBatcher& batch, const Camera& camera, const std::vector<SDL_Point>& cells,
+                        const SDL_Color& color) const;
 
     bool isInside(int x, int y) const;
     int getWidth() const { return width; }
@@ -32,15 +66,90 @@ public:
     bool blocksMovement(int x, int y) const;
     bool blocksLineOfSight(int x, int y) const;
 
+    // Bitboard views of the same data. The fills OR their mask into the
+    // board's rectangle and load the chunks it covers.
+    void fillMovementBlockers(BitBoard& board) const;
+    void fillSightBlockers(BitBoard& board) const;
+    void fillSpecials(BitBoard& board) const;
+
     TileSpecialType getSpecialType(int x, int y) const;
-    SpecialTileDefinition getSpecialDefinition(int x, int y) const;
+    // Returns an empty definition for tiles without a special. The reference
+    // is valid until the next load or removeItemAt.
+    const SpecialTileDefinition& getSpecialDefinition(int x, int y) const;
     void removeItemAt(int x, int y);
 
 private:
+    static constexpr size_t kMaxTerrainTypes = 256;
+    static constexpr size_t kTextureBudgetBytes = 96 * 1024 * 1024;
+    static constexpr int kChunkMask = kChunkSize - 1;
+    static constexpr uint32_t kNoChunk = 0xFFFFFFFFu;
+
+    // One byte per tile indexing terrainTable, plus bitplanes mirroring the
+    // table's blocking flags so the hot checks read one bit. A chunk row is
+    // exactly one bitplane word.
+    struct Chunk {
+        uint8_t terrain[kChunkSize * kChunkSize];
+        uint64_t movementBlockers[kChunkSize];
+        uint64_t sightBlockers[kChunkSize];
+    };
+
     int width;
     int height;
     int tileSize;
-    std::vector<std::vector<TileData>> tiles;
+    int chunksWide;
+    int chunksHigh;
+    std::shared_ptr<const MapTerrainSource> terrainSource;
+    std::vector<TerrainTypeDefinition> terrainTable;
+    SymbolMap<uint8_t> terrainSlots;
+    uint8_t plainSlot;
+    size_t chunkBudget;
+    std::vector<SDL_Point> focusChunks;
+    mutable std::vector<std::unique_ptr<Chunk>> chunks;
+    mutable std::vector<std::list<uint32_t>::iterator> lruPositions;
+    mutable std::list<uint32_t> lru;
+    mutable uint32_t lastChunk;
+    mutable std::vector<Symbol> chunkIds;
+    // Cached chunk images, tracked in their own LRU since their size is
+    // set by the tile size rather than by the terrain data.
+    struct ChunkTexture {
+        SDL_Texture* texture = nullptr;
+        bool grid = false;
+        uint64_t lastFrame = 0;
+        std::vector<SDL_Point> dirtyTiles;
+        std::list<uint32_t>::iterator lruPosition;
+    };
+    mutable std::vector<ChunkTexture> textures;
+    mutable std::list<uint32_t> textureLru;
+    mutable size_t textureBytes;
+    mutable uint64_t frame;
+    mutable bool texturesUnsupported;
+    // Specials are sparse: a bit per tile says whether one exists, and the
+    // definitions are sorted by tile index for a binary search.
+    BitBoard specialMarkers;
+    std::vector<uint32_t> specialTiles;
+    std::vector<SpecialTileDefinition> specials;
+
+    size_t tileIndex(int x, int y) const { return static_cast<size_t>(y) * width + x; }
+    const Chunk& chunkAt(int x, int y) const;
+    uint8_t terrainSlotAt(int x, int y) const {
+        return chunkAt(x, y).terrain[((y & kChunkMask) << kChunkShift) | (x & kChunkMask)];
+    }
+    const TerrainTypeDefinition& terrainAt(int x, int y) const { return terrainTable[terrainSlotAt(x, y)]; }
+    const SpecialTileDefinition* findSpecial(int x, int y) const;
+    void buildTerrainTable(const SymbolMap<TerrainTypeDefinition>& terrainTypes);
+    void dropChunks();
+    void loadChunk(uint32_t index) const;
+    void evictChunks(uint32_t keep) const;
+    bool isNearFocus(uint32_t index) const;
+    void setBlockers(Chunk& chunk, int localX, int localY, uint8_t slot) const;
+    void fillBlockers(BitBoard& board, const uint64_t (Chunk::*plane)[kChunkSize]) const;
+    SDL_Rect chunkBounds(uint32_t index) const;
+    void drawTile(RenderBatcher& batch, int x, int y, const SDL_Rect& rect, bool drawGrid) const;
+    SDL_Rect textureRect(const SDL_Rect& bounds, int x, int y) const;
+    bool refreshTexture(RenderBatcher& batch, uint32_t index, bool drawGrid) const;
+    void destroyTexture(uint32_t index) const;
+    void markTileDirty(int x, int y);
+    void invalidateTextures();
 };
 
 #endif // MAP_H
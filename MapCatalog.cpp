@@ -0,0 +1,208 @@
+#include "MapCatalog.h"
+#include "GameContent.h"
+
+DefinitionTerrainSource::DefinitionTerrainSource(std::shared_ptr<const MapDefinition> definition)
+    : definition(std::move(definition)) {}
+
+bool DefinitionTerrainSource::readTerrain(int x, int y, int width, int height, std::vector<Symbol>& ids) const {
+    ids.assign(static_cast<size_t>(width) * height, Symbol());
+    const auto& rows = definition->terrainIds;
+    for (int row = 0; row < height && y + row < static_cast<int>(rows.size()); ++row) {
+        const std::vector<Symbol>& source = rows[y + row];
+        for (int column = 0; column < width && x + column < static_cast<int>(source.size()); ++column) {
+            ids[static_cast<size_t>(row) * width + column] = source[x + column];
+        }
+    }
+    return true;
+}
+
+MapCatalog::MapCatalog() : residentBytes(0), budget(kDefaultBudgetBytes) {}
+
+std::shared_ptr<MapCatalog> MapCatalog::clone() const {
+    auto copy = std::make_shared<MapCatalog>();
+    std::lock_guard<std::mutex> lock(mutex);
+    copy->source = source;
+    copy->budget = budget;
+    copy->order = order;
+    for (const auto& item : entries) {
+        Entry& entry = copy->entries[item.first];
+        entry.recordIndex = item.second.recordIndex;
+        if (item.second.definition && !item.second.inLru) {
+            copy->setDefinition(entry, item.first, item.second.definition);
+        }
+    }
+    // Oldest first, so the copy's LRU ends up in the same order.
+    for (auto it = lru.rbegin(); it != lru.rend(); ++it) {
+        const Entry& original = entries.find(*it)->second;
+        copy->setDefinition(copy->entries[*it], *it, original.definition);
+    }
+    return copy;
+}
+
+void MapCatalog::setSource(std::shared_ptr<const MapSource> mapSource) {
+    std::lock_guard<std::mutex> lock(mutex);
+    source = std::move(mapSource);
+}
+
+void MapCatalog::setBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    budget = bytes;
+    evict(Symbol());
+}
+
+size_t MapCatalog::getBudget() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return budget;
+}
+
+size_t MapCatalog::getResidentBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return residentBytes;
+}
+
+MapCatalog::Entry* MapCatalog::findEntry(Symbol id) {
+    auto it = entries.find(id);
+    if (it == entries.end()) {
+        order.push_back(id);
+        return &entries[id];
+    }
+    return &it->second;
+}
+
+void MapCatalog::add(Symbol id, size_t recordIndex) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Entry& entry = *findEntry(id);
+    dropDefinition(entry);
+    entry.recordIndex = recordIndex;
+}
+
+void MapCatalog::add(MapDefinition&& definition, size_t recordIndex) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Symbol id = definition.id;
+    Entry& entry = *findEntry(id);
+    dropDefinition(entry);
+    entry.recordIndex = recordIndex;
+    setDefinition(entry, id, std::make_shared<const MapDefinition>(std::move(definition)));
+    evict(id);
+}
+
+bool MapCatalog::contains(Symbol id) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.find(id) != entries.end();
+}
+
+std::shared_ptr<const MapDefinition> MapCatalog::get(Symbol id) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(id);
+    if (it == entries.end()) {
+        return nullptr;
+    }
+    Entry& entry = it->second;
+    if (entry.definition) {
+        touch(entry, id);
+        return entry.definition;
+    }
+    if (!source || entry.recordIndex == kNoRecord) {
+        return nullptr;
+    }
+    MapDefinition built;
+    if (!source->buildMap(entry.recordIndex, built)) {
+        return nullptr;
+    }
+    setDefinition(entry, id, std::make_shared<const MapDefinition>(std::move(built)));
+    evict(id);
+    return entry.definition;
+}
+
+std::shared_ptr<const MapTerrainSource> MapCatalog::openTerrain(Symbol id) const {
+    std::shared_ptr<const MapSource> recordSource;
+    size_t recordIndex = kNoRecord;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(id);
+        if (it == entries.end()) {
+            return nullptr;
+        }
+        recordIndex = it->second.recordIndex;
+        if (recordIndex != kNoRecord) {
+            recordSource = source;
+        }
+    }
+    if (recordSource) {
+        if (auto terrain = recordSource->openTerrain(recordIndex)) {
+            return terrain;
+        }
+    }
+    std::shared_ptr<const MapDefinition> definition = get(id);
+    if (!definition) {
+        return nullptr;
+    }
+    return std::make_shared<DefinitionTerrainSource>(std::move(definition));
+}
+
+void MapCatalog::setDefinition(Entry& entry, Symbol id, std::shared_ptr<const MapDefinition> definition) const {
+    entry.bytes = estimateBytes(*definition);
+    entry.definition = std::move(definition);
+    residentBytes += entry.bytes;
+    touch(entry, id);
+}
+
+void MapCatalog::touch(Entry& entry, Symbol id) const {
+    if (entry.recordIndex == kNoRecord) {
+        return;
+    }
+    if (entry.inLru) {
+        lru.splice(lru.begin(), lru, entry.lruPosition);
+    } else {
+        lru.push_front(id);
+        entry.lruPosition = lru.begin();
+        entry.inLru = true;
+    }
+}
+
+void MapCatalog::dropDefinition(Entry& entry) const {
+    if (entry.inLru) {
+        lru.erase(entry.lruPosition);
+        entry.inLru = false;
+    }
+    if (entry.definition) {
+        residentBytes -= entry.bytes;
+        entry.definition.reset();
+        entry.bytes = 0;
+    }
+}
+
+// Only rebuildable maps are evicted; callers still holding a definition keep
+// it alive, it just stops counting against the budget.
+void MapCatalog::evict(Symbol keep) const {
+    auto it = lru.end();
+    while (residentBytes > budget && it != lru.begin()) {
+        --it;
+        if (*it == keep) {
+            continue;
+        }
+        Entry& entry = entries.find(*it)->second;
+        auto next = it;
+        ++next;
+        dropDefinition(entry);
+        it = next;
+    }
+}
+
+size_t MapCatalog::estimateBytes(const MapDefinition& definition) {
+    size_t bytes = sizeof(MapDefinition) + definition.name.capacity() + definition.rhythm.capacity();
+    for (const auto& row : definition.terrainIds) {
+        bytes += sizeof(row) + row.capacity() * sizeof(Symbol);
+    }
+    bytes += definition.specials.capacity() * sizeof(SpecialTileDefinition);
+    bytes += definition.objectives.capacity() * sizeof(MissionObjectiveDefinition);
+    for (const auto& objective : definition.objectives) {
+        bytes += objective.description.capacity();
+    }
+    for (const auto& condition : definition.loseConditions) {
+        bytes += sizeof(condition) + condition.capacity();
+    }
+    bytes += (definition.playerIds.capacity() + definition.enemyIds.capacity() + definition.npcIds.capacity()) * sizeof(Symbol);
+    bytes += (definition.playerSpawns.capacity() + definition.enemySpawns.capacity() + definition.npcSpawns.capacity()) * sizeof(SDL_Point);
+    return bytes;
+}
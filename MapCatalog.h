@@ -0,0 +1,103 @@
+#ifndef MAPCATALOG_H
+#define MAPCATALOG_H
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "Symbol.h"
+
+struct MapDefinition;
+
+// Reads a rectangle of one map's terrain ids into `ids`, row-major. Cells
+// past the end of a short source row come back as the empty symbol.
+class MapTerrainSource {
+public:
+    virtual ~MapTerrainSource() = default;
+    virtual bool readTerrain(int x, int y, int width, int height, std::vector<Symbol>& ids) const = 0;
+};
+
+// Terrain served from a definition's resident rows.
+class DefinitionTerrainSource : public MapTerrainSource {
+public:
+    explicit DefinitionTerrainSource(std::shared_ptr<const MapDefinition> definition);
+    bool readTerrain(int x, int y, int width, int height, std::vector<Symbol>& ids) const override;
+
+private:
+    std::shared_ptr<const MapDefinition> definition;
+};
+
+// Rebuilds a map definition from the record it was indexed from.
+class MapSource {
+public:
+    virtual ~MapSource() = default;
+    virtual bool buildMap(size_t recordIndex, MapDefinition& definition) const = 0;
+    // Direct access to a record's terrain, for sources that can read parts
+    // of it without building the map. Null when unsupported.
+    virtual std::shared_ptr<const MapTerrainSource> openTerrain(size_t /*recordIndex*/) const { return nullptr; }
+};
+
+// Map ids in source order, with definitions built on first access and kept
+// in an LRU cache bounded by an approximate byte budget. Maps added already
+// built without a source record stay resident.
+class MapCatalog {
+public:
+    static constexpr size_t kDefaultBudgetBytes = 64 * 1024 * 1024;
+    static constexpr size_t kNoRecord = static_cast<size_t>(-1);
+
+    MapCatalog();
+
+    MapCatalog(const MapCatalog&) = delete;
+    MapCatalog& operator=(const MapCatalog&) = delete;
+
+    // Independent catalog with the same source, order and resident maps.
+    std::shared_ptr<MapCatalog> clone() const;
+
+    void setSource(std::shared_ptr<const MapSource> mapSource);
+    void setBudget(size_t bytes);
+    size_t getBudget() const;
+    size_t getResidentBytes() const;
+
+    // A later map with the same id replaces the earlier one but keeps its
+    // place in the order.
+    void add(Symbol id, size_t recordIndex);
+    void add(MapDefinition&& definition, size_t recordIndex = kNoRecord);
+
+    bool contains(Symbol id) const;
+    bool empty() const { return order.empty(); }
+    size_t size() const { return order.size(); }
+    const std::vector<Symbol>& getOrder() const { return order; }
+    // Null when the id is unknown or its record cannot be built.
+    std::shared_ptr<const MapDefinition> get(Symbol id) const;
+    // Terrain of a map, read from the source record when it supports that
+    // and from the built definition otherwise.
+    std::shared_ptr<const MapTerrainSource> openTerrain(Symbol id) const;
+
+    static size_t estimateBytes(const MapDefinition& definition);
+
+private:
+    struct Entry {
+        size_t recordIndex = kNoRecord;
+        std::shared_ptr<const MapDefinition> definition;
+        size_t bytes = 0;
+        bool inLru = false;
+        std::list<Symbol>::iterator lruPosition;
+    };
+
+    mutable std::mutex mutex;
+    std::shared_ptr<const MapSource> source;
+    std::vector<Symbol> order;
+    mutable SymbolMap<Entry> entries;
+    mutable std::list<Symbol> lru;
+    mutable size_t residentBytes;
+    size_t budget;
+
+    Entry* findEntry(Symbol id);
+    void setDefinition(Entry& entry, Symbol id, std::shared_ptr<const MapDefinition> definition) const;
+    void touch(Entry& entry, Symbol id) const;
+    void dropDefinition(Entry& entry) const;
+    void evict(Symbol keep) const;
+};
+
+#endif
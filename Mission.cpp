@@ -8,10 +8,10 @@ Mission::Mission(const std::vector<MissionObjectiveDefinition>& definitions) {
     }
 }
 
-void Mission::registerEnemyDefeated(const std::string& enemyId) {
+void Mission::registerEnemyDefeated(Symbol enemyId) {
     for (auto& objective : objectives) {
         if (objective.definition.type == ObjectiveType::DefeatEnemies &&
-            (objective.definition.targetId.empty() || objective.definition.targetId == enemyId)) {
+            (objective.definition.targetId.isEmpty() || objective.definition.targetId == enemyId)) {
             objective.progress++;
             if (objective.definition.amount == 0 || objective.progress >= objective.definition.amount) {
                 objective.completed = true;
@@ -20,20 +20,20 @@ void Mission::registerEnemyDefeated(const std::string& enemyId) {
     }
 }
 
-void Mission::registerNpcConversation(const std::string& npcId) {
+void Mission::registerNpcConversation(Symbol npcId) {
     for (auto& objective : objectives) {
         if (objective.definition.type == ObjectiveType::TalkToNpc &&
-            (objective.definition.targetId.empty() || objective.definition.targetId == npcId)) {
+            (objective.definition.targetId.isEmpty() || objective.definition.targetId == npcId)) {
             objective.progress = 1;
             objective.completed = true;
         }
     }
 }
 
-void Mission::registerItemCollected(const std::string& itemId) {
+void Mission::registerItemCollected(Symbol itemId) {
     for (auto& objective : objectives) {
         if (objective.definition.type == ObjectiveType::CollectItem &&
-            (objective.definition.targetId.empty() || objective.definition.targetId == itemId)) {
+            (objective.definition.targetId.isEmpty() || objective.definition.targetId == itemId)) {
             objective.progress++;
             if (objective.definition.amount == 0 || objective.progress >= objective.definition.amount) {
                 objective.completed = true;
@@ -16,9 +16,9 @@ public:
     Mission();
     explicit Mission(const std::vector<MissionObjectiveDefinition>& definitions);
 
-    void registerEnemyDefeated(const std::string& enemyId);
-    void registerNpcConversation(const std::string& npcId);
-    void registerItemCollected(const std::string& itemId);
+    void registerEnemyDefeated(Symbol enemyId);
+    void registerNpcConversation(Symbol npcId);
+    void registerItemCollected(Symbol itemId);
     void registerTileReached(int x, int y);
     void registerSurvivedTurn();
 
@@ -0,0 +1,121 @@
+#include "MovementField.h"
+#include "Map.h"
+#include <algorithm>
+
+MovementField::MovementField() : area{0, 0, 0, 0}, origin{0, 0}, maxCost(-1) {}
+
+void MovementField::clear() {
+    area = {0, 0, 0, 0};
+    maxCost = -1;
+    costs.clear();
+    blocked.reset({0, 0, 0, 0});
+}
+
+void MovementField::compute(const Map& map, const BitBoard& obstacles, const SDL_Point& start, int budget) {
+    origin = start;
+    maxCost = std::max(0, budget);
+    // Every step costs at least 1, so nothing past maxCost tiles is reached.
+    const int left = std::max(0, start.x - maxCost);
+    const int top = std::max(0, start.y - maxCost);
+    area = {left, top, std::min(map.getWidth(), start.x + maxCost + 1) - left,
+            std::min(map.getHeight(), start.y + maxCost + 1) - top};
+    if (area.w <= 0 || area.h <= 0 || !map.isInside(start.x, start.y)) {
+        clear();
+        return;
+    }
+    costs.assign(static_cast<size_t>(area.w) * area.h, -1);
+    blocked = obstacles;
+    if (buckets.size() < static_cast<size_t>(maxCost) + 1) {
+        buckets.resize(static_cast<size_t>(maxCost) + 1);
+    }
+    for (int cost = 0; cost <= maxCost; ++cost) {
+        buckets[cost].clear();
+    }
+
+    const uint32_t first = static_cast<uint32_t>((start.y - top) * area.w + (start.x - left));
+    costs[first] = 0;
+    buckets[0].push_back(first);
+    const int dirs[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+    for (int cost = 0; cost <= maxCost; ++cost) {
+        // Steps cost at least 1, so nothing is added to this bucket while
+        // it is walked.
+        for (uint32_t cell : buckets[cost]) {
+            if (costs[cell] != cost) {
+                continue; // superseded by a cheaper entry
+            }
+            const int x = area.x + static_cast<int>(cell % area.w);
+            const int y = area.y + static_cast<int>(cell / area.w);
+            for (const auto& dir : dirs) {
+                const int nx = x + dir[0];
+                const int ny = y + dir[1];
+                if (nx < area.x || ny < area.y || nx >= area.x + area.w || ny >= area.y + area.h ||
+                    obstacles.test(nx, ny)) {
+                    continue;
+                }
+                const int next = cost + map.getMovementCost(nx, ny);
+                const uint32_t neighbor = static_cast<uint32_t>((ny - area.y) * area.w + (nx - area.x));
+                if (next <= maxCost && (costs[neighbor] == -1 || next < costs[neighbor])) {
+                    costs[neighbor] = next;
+                    buckets[next].push_back(neighbor);
+                }
+            }
+        }
+    }
+}
+
+// Blocking a tile only changes costs beyond its own, and freeing one only
+// changes costs beyond the cheapest way into it, so the field stands when
+// every changed tile is past the budget on both counts. Costs between the
+// new and the old budget are hidden rather than repaired.
+bool MovementField::reuse(const Map& map, const BitBoard& obstacles, const SDL_Point& start, int budget) {
+    if (maxCost < 0 || budget < 0 || budget > maxCost || start.x != origin.x || start.y != origin.y) {
+        return false;
+    }
+    // Tiles outside this square are more than `budget` steps away.
+    const int left = std::max(area.x, start.x - budget);
+    const int top = std::max(area.y, start.y - budget);
+    const int right = std::min(area.x + area.w, start.x + budget + 1);
+    const int bottom = std::min(area.y + area.h, start.y + budget + 1);
+    const int dirs[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+    for (int y = top; y < bottom; ++y) {
+        for (int x = left; x < right; x += 64) {
+            uint64_t changed = obstacles.wordAt(x, y) ^ blocked.wordAt(x, y);
+            if (right - x < 64) {
+                changed &= (uint64_t(1) << (right - x)) - 1;
+            }
+            while (changed) {
+                const int tileX = x + __builtin_ctzll(changed);
+                changed &= changed - 1;
+                if (obstacles.test(tileX, y)) {
+                    const int cost = getCost(tileX, y);
+                    if (cost >= 0 && cost <= budget) {
+                        return false;
+                    }
+                    continue;
+                }
+                const int enterCost = map.getMovementCost(tileX, y);
+                for (const auto& dir : dirs) {
+                    const int cost = getCost(tileX + dir[0], y + dir[1]);
+                    if (cost >= 0 && cost + enterCost <= budget) {
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+    maxCost = budget;
+    return true;
+}
+
+std::vector<SDL_Point> MovementField::getReachableCells() const {
+    std::vector<SDL_Point> cells;
+    for (int y = 0; y < area.h; ++y) {
+        for (int x = 0; x < area.w; ++x) {
+            const int cost = costs[static_cast<size_t>(y) * area.w + x];
+            if (cost > 0 && cost <= maxCost) {
+                cells.push_back({area.x + x, area.y + y});
+            }
+        }
+    }
+    return cells;
+}
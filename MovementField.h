@@ -0,0 +1,56 @@
+#ifndef MOVEMENTFIELD_H
+#define MOVEMENTFIELD_H
+
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "BitBoard.h"
+
+class Map;
+
+// Cheapest movement cost from one tile to every tile reachable within a
+// budget. Step costs are small integers, so tiles are settled with a bucket
+// queue (Dial's algorithm): one bucket per total cost, each tile expanded
+// exactly once. Buffers cover only the square the budget can reach and are
+// reused between calls.
+class MovementField {
+public:
+    MovementField();
+
+    // Tiles set in `obstacles` are never entered; the origin costs 0.
+    void compute(const Map& map, const BitBoard& obstacles, const SDL_Point& origin, int maxCost);
+    // Keeps the stored costs for a budget no larger than the computed one
+    // when the obstacles changed only where no cost within that budget can
+    // depend on them. Returns false, leaving the field untouched, when it
+    // has to be computed again.
+    bool reuse(const Map& map, const BitBoard& obstacles, const SDL_Point& origin, int maxCost);
+    // Hides costs above `budget`, which must not exceed the current one.
+    void limit(int budget) { maxCost = std::min(maxCost, budget); }
+    void clear();
+
+    // -1 when the tile was not reached.
+    int getCost(int x, int y) const {
+        if (x < area.x || y < area.y || x >= area.x + area.w || y >= area.y + area.h) {
+            return -1;
+        }
+        const int cost = costs[static_cast<size_t>(y - area.y) * area.w + (x - area.x)];
+        return cost <= maxCost ? cost : -1;
+    }
+    const SDL_Rect& getArea() const { return area; }
+    const SDL_Point& getOrigin() const { return origin; }
+    int getMaxCost() const { return maxCost; }
+    // Reached tiles other than the origin.
+    std::vector<SDL_Point> getReachableCells() const;
+
+private:
+    SDL_Rect area;
+    SDL_Point origin;
+    int maxCost;
+    std::vector<int> costs;
+    // The obstacles the costs were computed with.
+    BitBoard blocked;
+    std::vector<std::vector<uint32_t>> buckets;
+};
+
+#endif
@@ -0,0 +1,105 @@
+#include "OccupancyGrid.h"
+#include "Entity.h"
+
+OccupancyGrid::OccupancyGrid() : width(0), height(0), version(0) {}
+
+void OccupancyGrid::reset(int tilesWide, int tilesHigh) {
+    width = std::max(0, tilesWide);
+    height = std::max(0, tilesHigh);
+    for (auto& mask : masks) {
+        mask.reset({0, 0, width, height});
+    }
+    units.clear();
+    stacked.clear();
+    ++version;
+}
+
+bool OccupancyGrid::isOccupied(int x, int y) const {
+    for (const auto& mask : masks) {
+        if (mask.test(x, y)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Units can share a tile, for instance when one is revived on a tile taken
+// since its death.
+void OccupancyGrid::add(Entity& entity) {
+    const SDL_Point tile = entity.getPosition();
+    if (!isInside(tile.x, tile.y)) {
+        return;
+    }
+    const uint32_t key = tileKey(tile.x, tile.y);
+    Occupant occupant = {&entity, entity.getFaction()};
+    auto it = units.find(key);
+    if (it == units.end()) {
+        units.emplace(key, occupant);
+    } else {
+        if (occupant.faction < it->second.faction) {
+            std::swap(occupant, it->second);
+        }
+        stacked.emplace(key, occupant);
+    }
+    masks[static_cast<int>(entity.getFaction())].set(tile.x, tile.y);
+    ++version;
+}
+
+void OccupancyGrid::remove(const Entity& entity) {
+    release(entity, entity.getPosition());
+}
+
+void OccupancyGrid::move(Entity& entity, const SDL_Point& from) {
+    release(entity, from);
+    add(entity);
+}
+
+void OccupancyGrid::release(const Entity& entity, const SDL_Point& tile) {
+    if (!isInside(tile.x, tile.y)) {
+        return;
+    }
+    const uint32_t key = tileKey(tile.x, tile.y);
+    auto top = units.find(key);
+    if (top == units.end()) {
+        return;
+    }
+    EntityFaction faction;
+    auto range = stacked.equal_range(key);
+    if (top->second.entity == &entity) {
+        faction = top->second.faction;
+        // Promote the unit of the first faction left on the tile.
+        auto next = range.first;
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second.faction < next->second.faction) {
+                next = it;
+            }
+        }
+        if (next == range.second) {
+            units.erase(top);
+        } else {
+            top->second = next->second;
+            stacked.erase(next);
+        }
+    } else {
+        auto it = range.first;
+        while (it != range.second && it->second.entity != &entity) {
+            ++it;
+        }
+        if (it == range.second) {
+            return;
+        }
+        faction = it->second.faction;
+        stacked.erase(it);
+    }
+
+    auto remaining = units.find(key);
+    bool factionLeft = remaining != units.end() && remaining->second.faction == faction;
+    range = stacked.equal_range(key);
+    for (auto it = range.first; it != range.second && !factionLeft; ++it) {
+        factionLeft = it->second.faction == faction;
+    }
+    if (!factionLeft) {
+        masks[static_cast<int>(faction)].clear(tile.x, tile.y);
+    }
+    ++version;
+}
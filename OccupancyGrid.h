@@ -0,0 +1,99 @@
+#ifndef OCCUPANCYGRID_H
+#define OCCUPANCYGRID_H
+
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include "BitBoard.h"
+#include "GameContent.h"
+
+class Entity;
+
+// Which living units stand on each tile. Entities report their own spawn,
+// moves and deaths once attached (see Entity::setOccupancyGrid), so the
+// grid never has to be rebuilt from the unit lists. Each faction has a
+// bit per tile for mask work, and units are looked up by tile in a hash
+// map that only grows with the unit count. Units sharing a tile are kept
+// in a second map, which stays empty in normal play.
+class OccupancyGrid {
+public:
+    OccupancyGrid();
+
+    void reset(int width, int height);
+
+    void add(Entity& entity);
+    void remove(const Entity& entity);
+    // `entity` already stands on its new tile.
+    void move(Entity& entity, const SDL_Point& from);
+
+    // The top unit of a shared tile is the one of the first faction, as in
+    // the Players, Enemies, Neutral order.
+    Entity* getEntityAt(int x, int y) const {
+        if (!isInside(x, y)) {
+            return nullptr;
+        }
+        auto it = units.find(tileKey(x, y));
+        return it == units.end() ? nullptr : it->second.entity;
+    }
+    bool isOccupied(int x, int y) const;
+    const BitBoard& getMask(EntityFaction faction) const { return masks[static_cast<int>(faction)]; }
+    // Bumped whenever a tile's occupancy changes.
+    uint64_t getVersion() const { return version; }
+
+    // Calls visit(Entity&) for each unit of `faction` inside `area`, a word
+    // of the faction mask at a time.
+    template <typename Visit>
+    void forEachIn(EntityFaction faction, const SDL_Rect& area, Visit visit) const {
+        const BitBoard& mask = getMask(faction);
+        const int left = std::max(0, area.x);
+        const int right = std::min(width, area.x + area.w);
+        for (int y = std::max(0, area.y); y < std::min(height, area.y + area.h); ++y) {
+            for (int x = left; x < right; x += 64) {
+                uint64_t bits = mask.wordAt(x, y);
+                if (right - x < 64) {
+                    bits &= (uint64_t(1) << (right - x)) - 1;
+                }
+                while (bits) {
+                    const uint32_t key = tileKey(x + __builtin_ctzll(bits), y);
+                    auto it = units.find(key);
+                    if (it != units.end() && it->second.faction == faction) {
+                        visit(*it->second.entity);
+                    }
+                    if (!stacked.empty()) {
+                        auto range = stacked.equal_range(key);
+                        for (auto below = range.first; below != range.second; ++below) {
+                            if (below->second.faction == faction) {
+                                visit(*below->second.entity);
+                            }
+                        }
+                    }
+                    bits &= bits - 1;
+                }
+            }
+        }
+    }
+
+private:
+    // The faction is kept as added, so a unit is released from the bits it
+    // set even if its definition changes.
+    struct Occupant {
+        Entity* entity;
+        EntityFaction faction;
+    };
+
+    int width;
+    int height;
+    BitBoard masks[kFactionCount];
+    // The top unit of each occupied tile.
+    std::unordered_map<uint32_t, Occupant> units;
+    // Every other unit on a shared tile.
+    std::unordered_multimap<uint32_t, Occupant> stacked;
+    uint64_t version;
+
+    uint32_t tileKey(int x, int y) const { return static_cast<uint32_t>(y) * static_cast<uint32_t>(width) + x; }
+    bool isInside(int x, int y) const { return x >= 0 && y >= 0 && x < width && y < height; }
+    void release(const Entity& entity, const SDL_Point& tile);
+};
+
+#endif
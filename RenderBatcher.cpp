@@ -0,0 +1,98 @@
+#include "RenderBatcher.h"
+
+namespace {
+bool sameColor(const SDL_Color& a, const SDL_Color& b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+}
+
+RenderBatcher::RenderBatcher() : renderer(nullptr), pendingQuads(0), geometryUnsupported(false) {}
+
+void RenderBatcher::fillRect(RenderLayer layer, const SDL_Rect& rect, const SDL_Color& color) {
+    if (rect.w <= 0 || rect.h <= 0) {
+        return;
+    }
+    layers[static_cast<size_t>(layer)].push_back({rect, color});
+    pendingQuads++;
+}
+
+void RenderBatcher::outlineRect(RenderLayer layer, const SDL_Rect& rect, const SDL_Color& color) {
+    fillRect(layer, {rect.x, rect.y, rect.w, 1}, color);
+    if (rect.h > 1) {
+        fillRect(layer, {rect.x, rect.y + rect.h - 1, rect.w, 1}, color);
+    }
+    fillRect(layer, {rect.x, rect.y + 1, 1, rect.h - 2}, color);
+    if (rect.w > 1) {
+        fillRect(layer, {rect.x + rect.w - 1, rect.y + 1, 1, rect.h - 2}, color);
+    }
+}
+
+void RenderBatcher::flush() {
+    if (pendingQuads == 0 || !renderer) {
+        return;
+    }
+    SDL_BlendMode previous = SDL_BLENDMODE_NONE;
+    SDL_GetRenderDrawBlendMode(renderer, &previous);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    if (geometryUnsupported || !submitGeometry()) {
+        submitRects();
+    }
+    SDL_SetRenderDrawBlendMode(renderer, previous);
+    current.quads += pendingQuads;
+    pendingQuads = 0;
+    for (auto& layer : layers) {
+        layer.clear();
+    }
+}
+
+bool RenderBatcher::submitGeometry() {
+    vertices.clear();
+    indices.clear();
+    for (const auto& layer : layers) {
+        for (const Quad& quad : layer) {
+            const float left = static_cast<float>(quad.rect.x);
+            const float top = static_cast<float>(quad.rect.y);
+            const float right = static_cast<float>(quad.rect.x + quad.rect.w);
+            const float bottom = static_cast<float>(quad.rect.y + quad.rect.h);
+            const int base = static_cast<int>(vertices.size());
+            vertices.push_back({{left, top}, quad.color, {0.0f, 0.0f}});
+            vertices.push_back({{right, top}, quad.color, {0.0f, 0.0f}});
+            vertices.push_back({{right, bottom}, quad.color, {0.0f, 0.0f}});
+            vertices.push_back({{left, bottom}, quad.color, {0.0f, 0.0f}});
+            for (int corner : {0, 1, 2, 0, 2, 3}) {
+                indices.push_back(base + corner);
+            }
+        }
+    }
+    current.drawCalls++;
+    if (SDL_RenderGeometry(renderer, nullptr, vertices.data(), static_cast<int>(vertices.size()), indices.data(),
+                           static_cast<int>(indices.size())) != 0) {
+        geometryUnsupported = true;
+        return false;
+    }
+    return true;
+}
+
+void RenderBatcher::submitRects() {
+    for (const auto& layer : layers) {
+        size_t start = 0;
+        while (start < layer.size()) {
+            const SDL_Color& color = layer[start].color;
+            rects.clear();
+            size_t end = start;
+            while (end < layer.size() && sameColor(layer[end].color, color)) {
+                rects.push_back(layer[end].rect);
+                end++;
+            }
+            SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
+            SDL_RenderFillRects(renderer, rects.data(), static_cast<int>(rects.size()));
+            current.drawCalls++;
+            start = end;
+        }
+    }
+}
+
+void RenderBatcher::endFrame() {
+    lastFrame = current;
+    current = RenderStats();
+}
@@ -0,0 +1,66 @@
+#ifndef RENDERBATCHER_H
+#define RENDERBATCHER_H
+
+#include <SDL2/SDL.h>
+#include <cstddef>
+#include <vector>
+
+// Flushed in this order, so a quad always covers the layers before it.
+enum class RenderLayer {
+    Terrain,
+    TerrainOverlay,
+    Grid,
+    Highlights,
+    Fog,
+    Entities,
+    EntityOutlines,
+    Count
+};
+
+struct RenderStats {
+    size_t drawCalls = 0;
+    size_t quads = 0;
+};
+
+// Collects solid quads and submits them in one SDL_RenderGeometry call per
+// flush, falling back to one SDL_RenderFillRects call per run of equal
+// colors when the renderer rejects geometry. Quads are alpha blended.
+class RenderBatcher {
+public:
+    RenderBatcher();
+
+    void setRenderer(SDL_Renderer* target) { renderer = target; }
+    SDL_Renderer* getRenderer() const { return renderer; }
+
+    void fillRect(RenderLayer layer, const SDL_Rect& rect, const SDL_Color& color);
+    // Same pixels as SDL_RenderDrawRect, as four one-pixel quads.
+    void outlineRect(RenderLayer layer, const SDL_Rect& rect, const SDL_Color& color);
+    // Must be called before the render target changes.
+    void flush();
+
+    // Draw calls made outside the batcher, so the frame total stays complete.
+    void countDrawCalls(size_t calls) { current.drawCalls += calls; }
+    void endFrame();
+    const RenderStats& getFrameStats() const { return lastFrame; }
+
+private:
+    struct Quad {
+        SDL_Rect rect;
+        SDL_Color color;
+    };
+
+    SDL_Renderer* renderer;
+    std::vector<Quad> layers[static_cast<size_t>(RenderLayer::Count)];
+    size_t pendingQuads;
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+    std::vector<SDL_Rect> rects;
+    bool geometryUnsupported;
+    RenderStats current;
+    RenderStats lastFrame;
+
+    bool submitGeometry();
+    void submitRects();
+};
+
+#endif
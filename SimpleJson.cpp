@@ -1,13 +1,103 @@
 #include "SimpleJson.h"
+#include <algorithm>
 #include <cctype>
+#include <charconv>
+#include <cstring>
+#include <limits>
 #include <stdexcept>
 
-SimpleJsonValue::SimpleJsonValue() : type(Type::Null), numberValue(0.0), boolValue(false) {}
-SimpleJsonValue::SimpleJsonValue(double number) : type(Type::Number), numberValue(number), boolValue(false) {}
-SimpleJsonValue::SimpleJsonValue(const std::string& text) : type(Type::String), numberValue(0.0), boolValue(false), stringValue(text) {}
-SimpleJsonValue::SimpleJsonValue(bool boolean) : type(Type::Bool), numberValue(0.0), boolValue(boolean) {}
-SimpleJsonValue::SimpleJsonValue(const Object& object) : type(Type::Object), numberValue(0.0), boolValue(false), objectValue(object) {}
-SimpleJsonValue::SimpleJsonValue(const Array& array) : type(Type::Array), numberValue(0.0), boolValue(false), arrayValue(array) {}
+namespace {
+const size_t kArenaBlockSize = 64 * 1024;
+
+static_assert(sizeof(SimpleJsonValue) == 16, "SimpleJsonValue should stay a compact 16-byte node");
+
+uint32_t checkedCount(size_t count) {
+    if (count > std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error("JSON container too large");
+    }
+    return static_cast<uint32_t>(count);
+}
+}
+
+SimpleJsonArena::SimpleJsonArena() : cursor(nullptr), remaining(0), currentBlockSize(0), bytesReserved(0) {}
+
+void* SimpleJsonArena::allocate(size_t bytes, size_t alignment) {
+    size_t padding = (alignment - reinterpret_cast<uintptr_t>(cursor) % alignment) % alignment;
+    if (padding + bytes > remaining) {
+        size_t blockSize = std::max(kArenaBlockSize, bytes + alignment);
+        blocks.push_back(std::unique_ptr<char[]>(new char[blockSize]));
+        bytesReserved += blockSize;
+        currentBlockSize = blockSize;
+        cursor = blocks.back().get();
+        remaining = blockSize;
+        padding = (alignment - reinterpret_cast<uintptr_t>(cursor) % alignment) % alignment;
+    }
+    char* result = cursor + padding;
+    cursor += padding + bytes;
+    remaining -= padding + bytes;
+    return result;
+}
+
+std::string_view SimpleJsonArena::copyString(std::string_view text) {
+    if (text.empty()) {
+        return std::string_view();
+    }
+    char* copy = static_cast<char*>(allocate(text.size(), 1));
+    std::memcpy(copy, text.data(), text.size());
+    return std::string_view(copy, text.size());
+}
+
+void SimpleJsonArena::reset() {
+    if (blocks.empty()) {
+        return;
+    }
+    // Keep the current block so a reused arena does not go back to the allocator.
+    blocks.erase(blocks.begin(), blocks.end() - 1);
+    cursor = blocks.back().get();
+    remaining = currentBlockSize;
+    bytesReserved = currentBlockSize;
+}
+
+SimpleJsonValue::SimpleJsonValue() : type(Type::Null), length(0), numberValue(0.0) {}
+SimpleJsonValue::SimpleJsonValue(double number) : type(Type::Number), length(0), numberValue(number) {}
+SimpleJsonValue::SimpleJsonValue(bool boolean) : type(Type::Bool), length(0), numberValue(0.0) {
+    boolValue = boolean;
+}
+
+SimpleJsonValue SimpleJsonValue::string(std::string_view text) {
+    SimpleJsonValue value;
+    value.type = Type::String;
+    value.length = checkedCount(text.size());
+    value.textValue = text.data();
+    return value;
+}
+
+SimpleJsonValue SimpleJsonValue::array(const SimpleJsonValue* items, uint32_t count) {
+    SimpleJsonValue value;
+    value.type = Type::Array;
+    value.length = count;
+    value.itemsValue = items;
+    return value;
+}
+
+SimpleJsonValue SimpleJsonValue::object(const SimpleJsonMember* members, uint32_t count) {
+    SimpleJsonValue value;
+    value.type = Type::Object;
+    value.length = count;
+    value.membersValue = members;
+    return value;
+}
+
+const SimpleJsonValue* SimpleJsonValue::Object::find(std::string_view key) const {
+    // Objects in content files are small; a backwards scan keeps the last
+    // duplicate key, like the map-based DOM did.
+    for (uint32_t i = count; i > 0; --i) {
+        if (members[i - 1].key == key) {
+            return &members[i - 1].value;
+        }
+    }
+    return nullptr;
+}
 
 double SimpleJsonValue::asNumber(double defaultValue) const {
     if (type == Type::Number) {
@@ -29,55 +119,165 @@ bool SimpleJsonValue::asBool(bool defaultValue) const {
 
 std::string SimpleJsonValue::asString(const std::string& defaultValue) const {
     if (type == Type::String) {
-        return stringValue;
+        return std::string(asStringView());
     }
     return defaultValue;
 }
 
-const SimpleJsonValue::Object& SimpleJsonValue::asObject() const {
+std::string_view SimpleJsonValue::asStringView(std::string_view defaultValue) const {
+    if (type != Type::String) {
+        return defaultValue;
+    }
+    return std::string_view(textValue, length);
+}
+
+SimpleJsonValue::Object SimpleJsonValue::asObject() const {
     if (type != Type::Object) {
         throw std::runtime_error("JSON value is not an object");
     }
-    return objectValue;
+    return Object(membersValue, length);
 }
 
-const SimpleJsonValue::Array& SimpleJsonValue::asArray() const {
+SimpleJsonValue::Array SimpleJsonValue::asArray() const {
     if (type != Type::Array) {
         throw std::runtime_error("JSON value is not an array");
     }
-    return arrayValue;
+    return Array(itemsValue, length);
 }
 
-bool SimpleJsonValue::hasKey(const std::string& key) const {
+bool SimpleJsonValue::hasKey(std::string_view key) const {
     if (type != Type::Object) {
         return false;
     }
-    return objectValue.find(key) != objectValue.end();
+    return asObject().find(key) != nullptr;
 }
 
-const SimpleJsonValue& SimpleJsonValue::operator[](const std::string& key) const {
-    static SimpleJsonValue nullValue;
+const SimpleJsonValue& SimpleJsonValue::operator[](std::string_view key) const {
+    static const SimpleJsonValue nullValue;
     if (type != Type::Object) {
         return nullValue;
     }
-    auto it = objectValue.find(key);
-    if (it == objectValue.end()) {
-        return nullValue;
+    const SimpleJsonValue* value = asObject().find(key);
+    return value ? *value : nullValue;
+}
+
+SimpleJsonDocument::SimpleJsonDocument() {}
+
+SimpleJsonDocumentBuilder::SimpleJsonDocumentBuilder(std::string_view stable)
+    : stableInput(stable), complete(false) {}
+
+std::string_view SimpleJsonDocumentBuilder::keep(std::string_view text) {
+    const char* begin = stableInput.data();
+    if (!stableInput.empty() && text.data() >= begin && text.data() + text.size() <= begin + stableInput.size()) {
+        return text;
+    }
+    return document.arena.copyString(text);
+}
+
+void SimpleJsonDocumentBuilder::addValue(SimpleJsonValue value, std::string_view keyInParent) {
+    if (frames.empty()) {
+        document.rootValue = std::move(value);
+        complete = true;
+    } else if (frames.back().isObject) {
+        memberStack.push_back({keyInParent, std::move(value)});
+    } else {
+        valueStack.push_back(std::move(value));
     }
-    return it->second;
 }
 
-SimpleJsonParser::SimpleJsonParser(const std::string& data) : input(data), index(0) {}
+void SimpleJsonDocumentBuilder::startObject() {
+    frames.push_back({true, memberStack.size(), pendingKey});
+}
+
+void SimpleJsonDocumentBuilder::key(std::string_view name) {
+    pendingKey = keep(name);
+}
+
+void SimpleJsonDocumentBuilder::endObject() {
+    Frame frame = frames.back();
+    frames.pop_back();
+    const uint32_t count = checkedCount(memberStack.size() - frame.base);
+    SimpleJsonMember* members = static_cast<SimpleJsonMember*>(
+        document.arena.allocate(count * sizeof(SimpleJsonMember), alignof(SimpleJsonMember)));
+    std::uninitialized_move(memberStack.begin() + frame.base, memberStack.end(), members);
+    memberStack.erase(memberStack.begin() + frame.base, memberStack.end());
+    addValue(SimpleJsonValue::object(members, count), frame.key);
+}
 
-SimpleJsonValue SimpleJsonParser::parse() {
+void SimpleJsonDocumentBuilder::startArray() {
+    frames.push_back({false, valueStack.size(), pendingKey});
+}
+
+void SimpleJsonDocumentBuilder::endArray() {
+    Frame frame = frames.back();
+    frames.pop_back();
+    const uint32_t count = checkedCount(valueStack.size() - frame.base);
+    SimpleJsonValue* items = static_cast<SimpleJsonValue*>(
+        document.arena.allocate(count * sizeof(SimpleJsonValue), alignof(SimpleJsonValue)));
+    std::uninitialized_move(valueStack.begin() + frame.base, valueStack.end(), items);
+    valueStack.erase(valueStack.begin() + frame.base, valueStack.end());
+    addValue(SimpleJsonValue::array(items, count), frame.key);
+}
+
+void SimpleJsonDocumentBuilder::nullValue() {
+    addValue(SimpleJsonValue(), pendingKey);
+}
+
+void SimpleJsonDocumentBuilder::boolValue(bool value) {
+    addValue(SimpleJsonValue(value), pendingKey);
+}
+
+void SimpleJsonDocumentBuilder::numberValue(double value) {
+    addValue(SimpleJsonValue(value), pendingKey);
+}
+
+void SimpleJsonDocumentBuilder::stringValue(std::string_view value) {
+    addValue(SimpleJsonValue::string(keep(value)), pendingKey);
+}
+
+void SimpleJsonDocumentBuilder::clear() {
+    document.arena.reset();
+    document.rootValue = SimpleJsonValue();
+    frames.clear();
+    valueStack.clear();
+    memberStack.clear();
+    pendingKey = std::string_view();
+    complete = false;
+}
+
+SimpleJsonDocument SimpleJsonDocumentBuilder::takeDocument() {
+    SimpleJsonDocument result = std::move(document);
+    document = SimpleJsonDocument();
+    clear();
+    return result;
+}
+
+SimpleJsonParser::SimpleJsonParser(const std::string& data)
+    : storage(data), input(storage), index(0), inPlace(false), handler(nullptr) {}
+
+SimpleJsonParser::SimpleJsonParser(std::string_view data)
+    : input(data), index(0), inPlace(true), handler(nullptr) {}
+
+SimpleJsonDocument SimpleJsonParser::parse() {
+    SimpleJsonDocumentBuilder builder(inPlace ? input : std::string_view());
+    parse(builder);
+    return builder.takeDocument();
+}
+
+void SimpleJsonParser::parse(SimpleJsonHandler& target) {
+    handler = &target;
+    index = 0;
+    structural.reset(input);
     skipWhitespace();
-    SimpleJsonValue value = parseValue();
-    return value;
+    parseValue();
+    handler = nullptr;
 }
 
+// Only whitespace lies between a whitespace byte and the next indexed
+// position. Any other byte is left for the caller to reject.
 void SimpleJsonParser::skipWhitespace() {
-    while (index < input.size() && std::isspace(static_cast<unsigned char>(input[index]))) {
-        index++;
+    if (index < input.size() && std::isspace(static_cast<unsigned char>(input[index]))) {
+        index = structural.nextAtOrAfter(index);
     }
 }
 
@@ -103,23 +303,33 @@ bool SimpleJsonParser::match(char expected) {
     return false;
 }
 
-SimpleJsonValue SimpleJsonParser::parseValue() {
+void SimpleJsonParser::parseValue() {
     skipWhitespace();
     char current = peek();
     if (current == '{') {
-        return parseObject();
+        parseObject();
+        return;
     } else if (current == '[') {
-        return parseArray();
+        parseArray();
+        return;
     } else if (current == '"') {
-        return parseString();
+        handler->stringValue(parseString());
+        return;
     } else if (std::isdigit(static_cast<unsigned char>(current)) || current == '-' ) {
-        return parseNumber();
+        parseNumber();
+        return;
     } else if (current == 't') {
-        return parseTrue();
+        expectLiteral("true");
+        handler->boolValue(true);
+        return;
     } else if (current == 'f') {
-        return parseFalse();
+        expectLiteral("false");
+        handler->boolValue(false);
+        return;
     } else if (current == 'n') {
-        return parseNull();
+        expectLiteral("null");
+        handler->nullValue();
+        return;
     }
     std::string token;
     if (current == '\0') {
@@ -132,14 +342,15 @@ SimpleJsonValue SimpleJsonParser::parseValue() {
     throw std::runtime_error("Unexpected token in JSON: " + token + " at position " + std::to_string(index));
 }
 
-SimpleJsonValue SimpleJsonParser::parseObject() {
+void SimpleJsonParser::parseObject() {
     match('{');
+    handler->startObject();
     skipWhitespace();
-    SimpleJsonValue::Object object;
 
     if (peek() == '}') {
         get();
-        return SimpleJsonValue(object);
+        handler->endObject();
+        return;
     }
 
     while (true) {
@@ -147,14 +358,13 @@ SimpleJsonValue SimpleJsonParser::parseObject() {
         if (peek() == '}') {
             break;
         }
-        SimpleJsonValue key = parseString();
+        handler->key(parseString());
         skipWhitespace();
         if (!match(':')) {
             throw std::runtime_error("Expected ':' in object");
         }
         skipWhitespace();
-        SimpleJsonValue value = parseValue();
-        object[key.asString()] = value;
+        parseValue();
         skipWhitespace();
         if (peek() == ',') {
             get();
@@ -166,24 +376,24 @@ SimpleJsonValue SimpleJsonParser::parseObject() {
     if (!match('}')) {
         throw std::runtime_error("Expected '}'");
     }
-    return SimpleJsonValue(object);
+    handler->endObject();
 }
 
-SimpleJsonValue SimpleJsonParser::parseArray() {
+void SimpleJsonParser::parseArray() {
     match('[');
+    handler->startArray();
     skipWhitespace();
-    SimpleJsonValue::Array array;
     if (peek() == ']') {
         get();
-        return SimpleJsonValue(array);
+        handler->endArray();
+        return;
     }
     while (true) {
         skipWhitespace();
         if (peek() == ']') {
             break;
         }
-        SimpleJsonValue value = parseValue();
-        array.push_back(value);
+        parseValue();
         skipWhitespace();
         if (peek() == ',') {
             get();
@@ -195,76 +405,77 @@ SimpleJsonValue SimpleJsonParser::parseArray() {
     if (!match(']')) {
         throw std::runtime_error("Expected ']'");
     }
-    return SimpleJsonValue(array);
+    handler->endArray();
 }
 
-SimpleJsonValue SimpleJsonParser::parseString() {
+std::string_view SimpleJsonParser::parseString() {
     if (!match('"')) {
         throw std::runtime_error("Expected opening quote for string");
     }
-    std::string text;
+    size_t start = index;
+    size_t close = structural.nextAtOrAfter(start);
+    if (close >= input.size()) {
+        throw std::runtime_error("Unterminated string");
+    }
+    const void* escape = std::memchr(input.data() + start, '\\', close - start);
+    if (escape == nullptr) {
+        index = close + 1;
+        return input.substr(start, close - start);
+    }
+
+    size_t end = static_cast<const char*>(escape) - input.data();
+    scratch.assign(input.substr(start, end - start));
+    index = end;
     while (true) {
-        char c = get();
-        if (c == '"') {
+        size_t runEnd = input.find_first_of("\"\\", index);
+        if (runEnd == std::string_view::npos) {
+            throw std::runtime_error("Unterminated string");
+        }
+        scratch.append(input.substr(index, runEnd - index));
+        index = runEnd + 1;
+        if (input[runEnd] == '"') {
             break;
         }
-        if (c == '\\') {
-            char next = get();
-            switch (next) {
-            case '"': text.push_back('"'); break;
-            case '\\': text.push_back('\\'); break;
-            case '/': text.push_back('/'); break;
-            case 'b': text.push_back('\b'); break;
-            case 'f': text.push_back('\f'); break;
-            case 'n': text.push_back('\n'); break;
-            case 'r': text.push_back('\r'); break;
-            case 't': text.push_back('\t'); break;
-            default: text.push_back(next); break;
-            }
-        } else {
-            text.push_back(c);
+        char next = get();
+        switch (next) {
+        case '"': scratch.push_back('"'); break;
+        case '\\': scratch.push_back('\\'); break;
+        case '/': scratch.push_back('/'); break;
+        case 'b': scratch.push_back('\b'); break;
+        case 'f': scratch.push_back('\f'); break;
+        case 'n': scratch.push_back('\n'); break;
+        case 'r': scratch.push_back('\r'); break;
+        case 't': scratch.push_back('\t'); break;
+        default: scratch.push_back(next); break;
         }
     }
-    return SimpleJsonValue(text);
+    return scratch;
 }
 
-SimpleJsonValue SimpleJsonParser::parseNumber() {
-    std::string numberStr;
-    if (peek() == '-') {
-        numberStr.push_back(get());
-    }
+void SimpleJsonParser::parseNumber() {
+    size_t start = index;
+    match('-');
     while (std::isdigit(static_cast<unsigned char>(peek()))) {
-        numberStr.push_back(get());
+        index++;
     }
-    if (peek() == '.') {
-        numberStr.push_back(get());
+    if (match('.')) {
         while (std::isdigit(static_cast<unsigned char>(peek()))) {
-            numberStr.push_back(get());
+            index++;
         }
     }
-    return SimpleJsonValue(std::stod(numberStr));
-}
-
-SimpleJsonValue SimpleJsonParser::parseTrue() {
-    if (input.substr(index, 4) != "true") {
-        throw std::runtime_error("Invalid literal");
-    }
-    index += 4;
-    return SimpleJsonValue(true);
-}
-
-SimpleJsonValue SimpleJsonParser::parseFalse() {
-    if (input.substr(index, 5) != "false") {
-        throw std::runtime_error("Invalid literal");
+    double number = 0.0;
+    const char* first = input.data() + start;
+    const char* last = input.data() + index;
+    std::from_chars_result result = std::from_chars(first, last, number);
+    if (result.ec != std::errc() || result.ptr != last) {
+        throw std::runtime_error("Invalid number at position " + std::to_string(start));
     }
-    index += 5;
-    return SimpleJsonValue(false);
+    handler->numberValue(number);
 }
 
-SimpleJsonValue SimpleJsonParser::parseNull() {
-    if (input.substr(index, 4) != "null") {
+void SimpleJsonParser::expectLiteral(std::string_view literal) {
+    if (input.substr(index, literal.size()) != literal) {
         throw std::runtime_error("Invalid literal");
     }
-    index += 4;
-    return SimpleJsonValue();
+    index += literal.size();
 }
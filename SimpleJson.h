@@ -1,13 +1,43 @@
 #ifndef SIMPLEJSON_H
 #define SIMPLEJSON_H
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <string>
-#include <unordered_map>
+#include <string_view>
 #include <vector>
+#include "JsonStructuralIndex.h"
 
+class SimpleJsonArena {
+public:
+    SimpleJsonArena();
+
+    SimpleJsonArena(SimpleJsonArena&&) noexcept = default;
+    SimpleJsonArena& operator=(SimpleJsonArena&&) noexcept = default;
+    SimpleJsonArena(const SimpleJsonArena&) = delete;
+    SimpleJsonArena& operator=(const SimpleJsonArena&) = delete;
+
+    void* allocate(size_t bytes, size_t alignment);
+    std::string_view copyString(std::string_view text);
+    void reset();
+    size_t getBytesReserved() const { return bytesReserved; }
+
+private:
+    std::vector<std::unique_ptr<char[]>> blocks;
+    char* cursor;
+    size_t remaining;
+    size_t currentBlockSize;
+    size_t bytesReserved;
+};
+
+struct SimpleJsonMember;
+
+// 16-byte node: children, keys and unescaped strings live in the owning
+// SimpleJsonDocument's arena; other strings point into the parsed input.
 class SimpleJsonValue {
 public:
-    enum class Type {
+    enum class Type : uint8_t {
         Null,
         Bool,
         Number,
@@ -16,58 +46,198 @@ public:
         Array
     };
 
-    using Object = std::unordered_map<std::string, SimpleJsonValue>;
-    using Array = std::vector<SimpleJsonValue>;
+    class Array {
+    public:
+        Array() : items(nullptr), count(0) {}
+        Array(const SimpleJsonValue* first, uint32_t size) : items(first), count(size) {}
+
+        const SimpleJsonValue* begin() const { return items; }
+        const SimpleJsonValue* end() const { return items + count; }
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        const SimpleJsonValue& operator[](size_t i) const { return items[i]; }
+
+    private:
+        const SimpleJsonValue* items;
+        uint32_t count;
+    };
+
+    class Object {
+    public:
+        Object() : members(nullptr), count(0) {}
+        Object(const SimpleJsonMember* first, uint32_t size) : members(first), count(size) {}
+
+        const SimpleJsonMember* begin() const { return members; }
+        const SimpleJsonMember* end() const;
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        const SimpleJsonValue* find(std::string_view key) const;
+
+    private:
+        const SimpleJsonMember* members;
+        uint32_t count;
+    };
 
     SimpleJsonValue();
     explicit SimpleJsonValue(double number);
-    explicit SimpleJsonValue(const std::string& text);
     explicit SimpleJsonValue(bool boolean);
-    explicit SimpleJsonValue(const Object& object);
-    explicit SimpleJsonValue(const Array& array);
+    // The referenced storage must outlive the value.
+    static SimpleJsonValue string(std::string_view text);
+    static SimpleJsonValue array(const SimpleJsonValue* items, uint32_t count);
+    static SimpleJsonValue object(const SimpleJsonMember* members, uint32_t count);
+
+    SimpleJsonValue(SimpleJsonValue&&) noexcept = default;
+    SimpleJsonValue& operator=(SimpleJsonValue&&) noexcept = default;
+    SimpleJsonValue(const SimpleJsonValue&) = delete;
+    SimpleJsonValue& operator=(const SimpleJsonValue&) = delete;
 
     Type getType() const { return type; }
     double asNumber(double defaultValue = 0.0) const;
     int asInt(int defaultValue = 0) const;
     bool asBool(bool defaultValue = false) const;
     std::string asString(const std::string& defaultValue = "") const;
-    const Object& asObject() const;
-    const Array& asArray() const;
+    std::string_view asStringView(std::string_view defaultValue = std::string_view()) const;
+    Object asObject() const;
+    Array asArray() const;
 
-    bool hasKey(const std::string& key) const;
-    const SimpleJsonValue& operator[](const std::string& key) const;
+    bool hasKey(std::string_view key) const;
+    const SimpleJsonValue& operator[](std::string_view key) const;
 
 private:
     Type type;
-    double numberValue;
-    bool boolValue;
-    std::string stringValue;
-    Object objectValue;
-    Array arrayValue;
+    uint32_t length;
+    union {
+        double numberValue;
+        bool boolValue;
+        const char* textValue;
+        const SimpleJsonValue* itemsValue;
+        const SimpleJsonMember* membersValue;
+    };
+};
+
+struct SimpleJsonMember {
+    std::string_view key;
+    SimpleJsonValue value;
+};
+
+inline const SimpleJsonMember* SimpleJsonValue::Object::end() const {
+    return members + count;
+}
+
+class SimpleJsonDocument {
+public:
+    SimpleJsonDocument();
+
+    SimpleJsonDocument(SimpleJsonDocument&&) noexcept = default;
+    SimpleJsonDocument& operator=(SimpleJsonDocument&&) noexcept = default;
+    SimpleJsonDocument(const SimpleJsonDocument&) = delete;
+    SimpleJsonDocument& operator=(const SimpleJsonDocument&) = delete;
+
+    const SimpleJsonValue& root() const { return rootValue; }
+    size_t getArenaBytes() const { return arena.getBytesReserved(); }
+
+private:
+    friend class SimpleJsonDocumentBuilder;
+
+    SimpleJsonArena arena;
+    SimpleJsonValue rootValue;
+};
+
+// Push-style events. String arguments are only valid for the duration of
+// the call.
+class SimpleJsonHandler {
+public:
+    virtual ~SimpleJsonHandler() = default;
+
+    virtual void startObject() = 0;
+    virtual void key(std::string_view name) = 0;
+    virtual void endObject() = 0;
+    virtual void startArray() = 0;
+    virtual void endArray() = 0;
+    virtual void nullValue() = 0;
+    virtual void boolValue(bool value) = 0;
+    virtual void numberValue(double value) = 0;
+    virtual void stringValue(std::string_view value) = 0;
+};
+
+// Builds a DOM from events. Strings that lie inside `stableInput` are kept
+// as views; anything else is copied into the document's arena.
+class SimpleJsonDocumentBuilder : public SimpleJsonHandler {
+public:
+    explicit SimpleJsonDocumentBuilder(std::string_view stableInput = std::string_view());
+
+    void startObject() override;
+    void key(std::string_view name) override;
+    void endObject() override;
+    void startArray() override;
+    void endArray() override;
+    void nullValue() override;
+    void boolValue(bool value) override;
+    void numberValue(double value) override;
+    void stringValue(std::string_view value) override;
+
+    bool isComplete() const { return complete; }
+    const SimpleJsonValue& root() const { return document.root(); }
+    size_t getArenaBytes() const { return document.getArenaBytes(); }
+    // Drops the current document but keeps arena memory for the next one.
+    void clear();
+    SimpleJsonDocument takeDocument();
+
+private:
+    struct Frame {
+        bool isObject;
+        size_t base;
+        std::string_view key;
+    };
+
+    std::string_view stableInput;
+    SimpleJsonDocument document;
+    std::vector<Frame> frames;
+    std::vector<SimpleJsonValue> valueStack;
+    std::vector<SimpleJsonMember> memberStack;
+    std::string_view pendingKey;
+    bool complete;
+
+    std::string_view keep(std::string_view text);
+    void addValue(SimpleJsonValue value, std::string_view keyInParent);
 };
 
 class SimpleJsonParser {
 public:
+    // Copies `data`; every string in the resulting document is owned by it.
     explicit SimpleJsonParser(const std::string& data);
-    SimpleJsonValue parse();
+    // Parses in place: `data` must outlive the returned document, since
+    // strings without escapes are views into it.
+    explicit SimpleJsonParser(std::string_view data);
+
+    SimpleJsonParser(const SimpleJsonParser&) = delete;
+    SimpleJsonParser& operator=(const SimpleJsonParser&) = delete;
+
+    SimpleJsonDocument parse();
+    void parse(SimpleJsonHandler& handler);
+    size_t getPosition() const { return index; }
 
 private:
-    std::string input;
+    std::string storage;
+    std::string_view input;
     size_t index;
+    bool inPlace;
+
+    JsonStructuralIndex structural;
+    SimpleJsonHandler* handler;
+    std::string scratch;
 
     void skipWhitespace();
     char peek() const;
     char get();
     bool match(char expected);
 
-    SimpleJsonValue parseValue();
-    SimpleJsonValue parseObject();
-    SimpleJsonValue parseArray();
-    SimpleJsonValue parseString();
-    SimpleJsonValue parseNumber();
-    SimpleJsonValue parseTrue();
-    SimpleJsonValue parseFalse();
-    SimpleJsonValue parseNull();
+    void parseValue();
+    void parseObject();
+    void parseArray();
+    std::string_view parseString();
+    void parseNumber();
+    void expectLiteral(std::string_view literal);
 };
 
 #endif
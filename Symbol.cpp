@@ -0,0 +1,50 @@
+#include "Symbol.h"
+#include <mutex>
+
+SymbolTable& SymbolTable::global() {
+    static SymbolTable table;
+    return table;
+}
+
+SymbolTable::SymbolTable() {
+    names.emplace_back();
+    index.emplace(std::string_view(names.back()), 0);
+}
+
+Symbol SymbolTable::intern(std::string_view name) {
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto it = index.find(name);
+        if (it != index.end()) {
+            return Symbol(it->second);
+        }
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    auto it = index.find(name);
+    if (it != index.end()) {
+        return Symbol(it->second);
+    }
+    uint32_t handle = static_cast<uint32_t>(names.size());
+    names.emplace_back(name);
+    index.emplace(std::string_view(names.back()), handle);
+    return Symbol(handle);
+}
+
+Symbol SymbolTable::find(std::string_view name) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    auto it = index.find(name);
+    return it != index.end() ? Symbol(it->second) : Symbol();
+}
+
+std::string_view SymbolTable::name(Symbol symbol) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    if (symbol.value >= names.size()) {
+        return std::string_view();
+    }
+    return names[symbol.value];
+}
+
+size_t SymbolTable::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return names.size();
+}
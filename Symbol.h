@@ -0,0 +1,69 @@
+#ifndef SYMBOL_H
+#define SYMBOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Dense 32-bit handle for an interned content identifier. The empty
+// identifier is always handle 0.
+class Symbol {
+public:
+    Symbol() : value(0) {}
+
+    uint32_t getHandle() const { return value; }
+    bool isEmpty() const { return value == 0; }
+
+    bool operator==(Symbol other) const { return value == other.value; }
+    bool operator!=(Symbol other) const { return value != other.value; }
+    bool operator<(Symbol other) const { return value < other.value; }
+
+private:
+    friend class SymbolTable;
+    explicit Symbol(uint32_t handle) : value(handle) {}
+
+    uint32_t value;
+};
+
+namespace std {
+template <>
+struct hash<Symbol> {
+    size_t operator()(Symbol symbol) const { return symbol.getHandle(); }
+};
+}
+
+class SymbolTable {
+public:
+    static SymbolTable& global();
+
+    SymbolTable();
+
+    Symbol intern(std::string_view name);
+    // Returns the empty symbol when `name` was never interned.
+    Symbol find(std::string_view name) const;
+    std::string_view name(Symbol symbol) const;
+    size_t size() const;
+
+private:
+    mutable std::shared_mutex mutex;
+    std::deque<std::string> names;
+    std::unordered_map<std::string_view, uint32_t> index;
+};
+
+inline Symbol internSymbol(std::string_view name) {
+    return SymbolTable::global().intern(name);
+}
+
+inline std::string_view symbolName(Symbol symbol) {
+    return SymbolTable::global().name(symbol);
+}
+
+template <typename T>
+using SymbolMap = std::unordered_map<Symbol, T>;
+
+#endif
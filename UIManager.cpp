@@ -163,7 +163,7 @@ void UIManager::render(SDL_Renderer* renderer,
         drawEntityLine("Nivel: " + std::to_string(currentEntity->getLevel()) + " (" +
                        std::to_string(currentEntity->getExperience()) + "/" + std::to_string(currentEntity->getExperienceToNext()) + " XP)");
         for (const auto& status : currentEntity->getStatuses()) {
-            drawEntityLine("Status: " + status.id + " (" + std::to_string(status.remainingTurns) + ")");
+            drawEntityLine("Status: " + std::string(symbolName(status.id)) + " (" + std::to_string(status.remainingTurns) + ")");
         }
     } else {
         drawEntityLine("Nenhum personagem ativo");
@@ -20,7 +20,7 @@ enum class UIActionType {
 };
 
 struct AbilityButtonEntry {
-    std::string abilityId;
+    Symbol abilityId;
     std::string label;
 };
 
@@ -0,0 +1,78 @@
+#include "WorkerPool.h"
+
+WorkerPool::WorkerPool(size_t threadCount)
+    : job(nullptr), jobCount(0), nextIndex(0), activeWorkers(0), generation(0), stopping(false) {
+    threads.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        threads.emplace_back(&WorkerPool::workerLoop, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+size_t WorkerPool::defaultThreadCount() {
+    unsigned int cores = std::thread::hardware_concurrency();
+    return cores > 1 ? cores - 1 : 0;
+}
+
+void WorkerPool::parallelFor(size_t count, const std::function<void(size_t)>& task) {
+    if (count == 0) {
+        return;
+    }
+    if (threads.empty() || count == 1) {
+        for (size_t i = 0; i < count; ++i) {
+            task(i);
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> runLock(runMutex);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &task;
+        jobCount = count;
+        nextIndex.store(0);
+        activeWorkers = threads.size();
+        generation++;
+    }
+    wake.notify_all();
+    drain();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this] { return activeWorkers == 0; });
+    job = nullptr;
+}
+
+void WorkerPool::workerLoop() {
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [&] { return stopping || generation != seen; });
+        if (stopping) {
+            return;
+        }
+        seen = generation;
+        lock.unlock();
+        drain();
+        lock.lock();
+        if (--activeWorkers == 0) {
+            finished.notify_one();
+        }
+    }
+}
+
+void WorkerPool::drain() {
+    size_t index;
+    while ((index = nextIndex.fetch_add(1)) < jobCount) {
+        (*job)(index);
+    }
+}
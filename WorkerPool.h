@@ -0,0 +1,47 @@
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of threads for index-parallel loops. The calling thread works
+// alongside them, so a pool of N threads runs N + 1 tasks at once.
+class WorkerPool {
+public:
+    explicit WorkerPool(size_t threadCount = defaultThreadCount());
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    static size_t defaultThreadCount();
+    size_t getThreadCount() const { return threads.size(); }
+
+    // Runs task(i) for every i in [0, count) and returns when all are done.
+    // Tasks are claimed in index order; `task` must not throw.
+    void parallelFor(size_t count, const std::function<void(size_t)>& task);
+
+private:
+    std::vector<std::thread> threads;
+    std::mutex runMutex;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    const std::function<void(size_t)>* job;
+    size_t jobCount;
+    std::atomic<size_t> nextIndex;
+    size_t activeWorkers;
+    uint64_t generation;
+    bool stopping;
+
+    void workerLoop();
+    void drain();
+};
+
+#endif
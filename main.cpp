@@ -1,4 +1,5 @@
 #include "Game.h"
+#include <cstring>
 
 Game* game = nullptr;
 
@@ -6,6 +7,11 @@ const int FPS = 60;
 const int frameDelay = 1000 / FPS;
 
 int main(int argc, char* argv[]) {
+    if (argc >= 2 && std::strcmp(argv[1], "--build-pack") == 0) {
+        GameDataLoader loader;
+        return loader.buildPack(argc >= 3 ? argv[2] : "data/game_data.json") ? 0 : 1;
+    }
+
     game = new Game();
     game->init("Everlasting Destiny", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 800, 640, false);
 
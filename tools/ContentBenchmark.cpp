@@ -0,0 +1,582 @@
+// Content loading benchmarks. Built from the repository root:
+//   g++ -std=c++17 -O2 -pthread -I. tools/ContentBenchmark.cpp SimpleJson.cpp JsonStructuralIndex.cpp MappedFile.cpp ContentPack.cpp GameDataLoader.cpp MapCatalog.cpp Symbol.cpp WorkerPool.cpp -o content_benchmark
+//   ./content_benchmark [data/game_data.json] [iterations]
+//       Quick startup comparison on one file.
+//   ./content_benchmark --generate out.json [--maps N] [--map-size N] [--entities N] [--abilities N] [--seed N]
+//       Writes a synthetic data file.
+//   ./content_benchmark --suite [--out results.jsonl] [--dir /tmp] [--iterations N] [generator options]
+//       Generates variants (a default matrix unless generator options are
+//       given) and writes one JSON line per variant and phase with time,
+//       allocation count and peak RSS.
+#include "GameDataLoader.h"
+#include "JsonStructuralIndex.h"
+#include "MappedFile.h"
+#include "SimpleJson.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+std::atomic<uint64_t> allocationCount(0);
+std::atomic<uint64_t> allocatedBytes(0);
+}
+
+// Counts every allocation made through the global operator new; the array
+// forms forward here by default.
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* block = std::malloc(size == 0 ? 1 : size)) {
+        return block;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* block) noexcept {
+    std::free(block);
+}
+
+void operator delete(void* block, size_t) noexcept {
+    std::free(block);
+}
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+template <typename Fn>
+double averageMilliseconds(int iterations, Fn&& fn) {
+    auto start = Clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        fn();
+    }
+    std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+size_t parseWithStream(const std::string& path) {
+    std::ifstream file(path);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    SimpleJsonParser parser(buffer.str());
+    SimpleJsonDocument document = parser.parse();
+    return document.root().asObject().size();
+}
+
+size_t parseMapped(const std::string& path) {
+    MappedFile file;
+    file.open(path);
+    SimpleJsonParser parser(file.view());
+    SimpleJsonDocument document = parser.parse();
+    return document.getArenaBytes();
+}
+
+class CountingJsonHandler : public SimpleJsonHandler {
+public:
+    size_t events = 0;
+
+    void startObject() override { events++; }
+    void key(std::string_view) override { events++; }
+    void endObject() override { events++; }
+    void startArray() override { events++; }
+    void endArray() override { events++; }
+    void nullValue() override { events++; }
+    void boolValue(bool) override { events++; }
+    void numberValue(double) override { events++; }
+    void stringValue(std::string_view) override { events++; }
+};
+
+int runQuick(const std::string& path, int iterations) {
+    MappedFile probe;
+    if (!probe.open(path)) {
+        std::cerr << "Unable to open data file: " << path << std::endl;
+        return 1;
+    }
+    const size_t bytes = probe.getSize();
+    probe.close();
+
+    size_t sink = 0;
+    double streamMs = averageMilliseconds(iterations, [&] { sink += parseWithStream(path); });
+    double mappedMs = averageMilliseconds(iterations, [&] { sink += parseMapped(path); });
+    double documentLoaderMs = averageMilliseconds(iterations, [&] {
+        MappedFile file;
+        file.open(path);
+        SimpleJsonParser parser(file.view());
+        SimpleJsonDocument document = parser.parse();
+        GameDataLoader loader;
+        loader.loadFromDocument(document.root());
+        sink += loader.getContent()->maps->size();
+    });
+    double streamedMs = averageMilliseconds(iterations, [&] {
+        MappedFile file;
+        file.open(path);
+        GameDataLoader loader;
+        loader.loadFromJson(file.view());
+        sink += loader.getContent()->maps->size();
+    });
+    GameDataLoader().buildPack(path);
+    double packMs = averageMilliseconds(iterations, [&] {
+        GameDataLoader loader;
+        loader.loadFromFile(path);
+        sink += loader.getContent()->maps->size();
+    });
+    double firstMapMs = averageMilliseconds(iterations, [&] {
+        GameDataLoader loader;
+        loader.loadFromFile(path);
+        const MapCatalog& maps = *loader.getContent()->maps;
+        if (!maps.empty() && maps.get(maps.getOrder().front())) {
+            sink++;
+        }
+    });
+
+    std::cout << path << " (" << bytes << " bytes, " << iterations << " iterations)\n";
+    std::cout << "  parse via ifstream/stringstream: " << streamMs << " ms\n";
+    std::cout << "  parse in place over mmap:        " << mappedMs << " ms";
+    if (mappedMs > 0.0) {
+        std::cout << " (" << streamMs / mappedMs << "x)";
+    }
+    std::cout << "\n";
+    std::cout << "  load from a full document:       " << documentLoaderMs << " ms\n";
+    std::cout << "  load streamed from JSON:         " << streamedMs << " ms\n";
+    std::cout << "  load from compiled .edpak:       " << packMs << " ms\n";
+    std::cout << "  .edpak plus first map built:     " << firstMapMs << " ms\n";
+    return sink == 0 ? 1 : 0;
+}
+
+// ---- synthetic data ----
+
+struct GeneratorOptions {
+    int maps = 4;
+    int mapSize = 64;
+    int entities = 200;
+    int abilities = 100;
+    int items = 50;
+    uint32_t seed = 1;
+};
+
+std::string describe(const GeneratorOptions& options) {
+    return "maps" + std::to_string(options.maps) + "_size" + std::to_string(options.mapSize) +
+           "_entities" + std::to_string(options.entities) + "_abilities" + std::to_string(options.abilities);
+}
+
+// Writes a data file in the shipped layout. Maps are runs of the stock
+// terrain ids, which is what real rows look like.
+bool writeSyntheticContent(const std::string& path, const GeneratorOptions& options) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Unable to write " << path << std::endl;
+        return false;
+    }
+    std::mt19937 rng(options.seed);
+    auto roll = [&](int low, int high) { return std::uniform_int_distribution<int>(low, high)(rng); };
+
+    const char* terrain[] = {"plain", "forest", "mountain", "water", "sanctuary"};
+    const char* targets[] = {"enemy", "self", "ally", "area"};
+    const char* effects[] = {"damage", "heal", "buff", "debuff", "status"};
+    const char* kinds[] = {"player", "enemy", "npc"};
+    const char* factions[] = {"players", "enemies", "neutral"};
+    const char* specials[] = {"trap", "heal", "portal", "item", "objective"};
+
+    out << "{\"terrain_types\": [";
+    for (int i = 0; i < 5; ++i) {
+        out << (i ? ", " : "") << "{\"id\": \"" << terrain[i] << "\", \"name\": \"Terrain " << i
+            << "\", \"movement_cost\": " << (i == 2 ? 3 : 1) << ", \"defense_bonus\": " << i % 3
+            << ", \"evasion_bonus\": " << i % 2 << ", \"blocks_movement\": " << (i == 3 ? "true" : "false")
+            << ", \"blocks_los\": " << (i == 2 ? "true" : "false") << ", \"color\": [" << 40 * i << ", "
+            << 200 - 30 * i << ", " << 20 * i << "]}";
+    }
+
+    out << "],\n\"abilities\": [";
+    for (int i = 0; i < options.abilities; ++i) {
+        out << (i ? ",\n" : "") << "{\"id\": \"ability_" << i << "\", \"name\": \"Ability " << i
+            << "\", \"description\": \"Generated ability " << i << "\", \"ap_cost\": " << roll(1, 4)
+            << ", \"energy_cost\": " << roll(0, 20) << ", \"range\": " << roll(1, 5) << ", \"target\": \""
+            << targets[roll(0, 3)] << "\", \"effect\": \"" << effects[roll(0, 4)] << "\", \"power\": "
+            << roll(1, 30) << "}";
+    }
+
+    out << "],\n\"items\": [";
+    for (int i = 0; i < options.items; ++i) {
+        out << (i ? ",\n" : "") << "{\"id\": \"item_" << i << "\", \"name\": \"Item " << i
+            << "\", \"description\": \"Generated item " << i << "\"}";
+    }
+
+    out << "],\n\"entities\": [";
+    for (int i = 0; i < options.entities; ++i) {
+        out << (i ? ",\n" : "") << "{\"id\": \"entity_" << i << "\", \"name\": \"Entity " << i
+            << "\", \"kind\": \"" << kinds[i % 3] << "\", \"faction\": \"" << factions[i % 3]
+            << "\", \"strength\": " << roll(1, 8) << ", \"agility\": " << roll(1, 8)
+            << ", \"intelligence\": " << roll(1, 8) << ", \"defense\": " << roll(1, 8) << ", \"hp\": "
+            << roll(40, 160) << ", \"energy\": " << roll(20, 80) << ", \"attack\": " << roll(5, 20)
+            << ", \"range\": " << roll(1, 3) << ", \"abilities\": [";
+        int abilityCount = options.abilities > 0 ? roll(1, 4) : 0;
+        for (int a = 0; a < abilityCount; ++a) {
+            out << (a ? ", " : "") << "\"ability_" << roll(0, options.abilities - 1) << "\"";
+        }
+        out << "]";
+        if (i % 3 == 2) {
+            out << ", \"dialog\": \"Generated dialog " << i << "\"";
+        }
+        out << "}";
+    }
+
+    out << "],\n\"maps\": [";
+    const int size = options.mapSize;
+    for (int m = 0; m < options.maps; ++m) {
+        out << (m ? ",\n" : "") << "{\"id\": \"map_" << m << "\", \"name\": \"Map " << m
+            << "\", \"mode\": \"cooperative\", \"rhythm\": \"curta\", \"width\": " << size << ", \"height\": "
+            << size << ", \"turn_limit\": " << roll(10, 40);
+        const char* idKeys[] = {"player_ids", "enemy_ids", "npc_ids"};
+        const char* spawnKeys[] = {"player_spawns", "enemy_spawns", "npc_spawns"};
+        for (int group = 0; group < 3; ++group) {
+            int count = options.entities >= 3 ? roll(1, 4) : 0;
+            std::vector<int> ids;
+            for (int k = 0; k < count; ++k) {
+                ids.push_back(roll(0, (options.entities - 1) / 3) * 3 + group);
+            }
+            out << ", \"" << idKeys[group] << "\": [";
+            for (size_t k = 0; k < ids.size(); ++k) {
+                out << (k ? ", " : "") << "\"entity_" << std::min(ids[k], options.entities - 1) << "\"";
+            }
+            out << "], \"" << spawnKeys[group] << "\": [";
+            for (size_t k = 0; k < ids.size(); ++k) {
+                out << (k ? ", " : "") << "{\"x\": " << roll(0, size - 1) << ", \"y\": " << roll(0, size - 1) << "}";
+            }
+            out << "]";
+        }
+
+        out << ", \"rows\": [";
+        for (int y = 0; y < size; ++y) {
+            out << (y ? ",\n" : "\n") << "[";
+            int x = 0;
+            while (x < size) {
+                const char* id = terrain[roll(0, 9) < 6 ? 0 : roll(1, 4)];
+                int run = std::min(size - x, roll(1, 12));
+                for (int r = 0; r < run; ++r, ++x) {
+                    out << (x ? ", \"" : "\"") << id << "\"";
+                }
+            }
+            out << "]";
+        }
+
+        out << "], \"special_tiles\": [";
+        int specialCount = std::max(1, size * size / 256);
+        for (int s = 0; s < specialCount; ++s) {
+            int type = roll(0, 4);
+            out << (s ? ", " : "") << "{\"type\": \"" << specials[type] << "\", \"x\": " << roll(0, size - 1)
+                << ", \"y\": " << roll(0, size - 1) << ", \"value\": " << roll(1, 20);
+            if (type == 2) {
+                out << ", \"target\": \"" << roll(0, size - 1) << "," << roll(0, size - 1) << "\"";
+            } else if (type == 3 && options.items > 0) {
+                out << ", \"target\": \"item_" << roll(0, options.items - 1) << "\"";
+            }
+            out << "}";
+        }
+        out << "], \"objectives\": [{\"type\": \"defeat\", \"description\": \"Defeat the enemies\", \"amount\": "
+            << roll(1, 5) << "}, {\"type\": \"reach\", \"description\": \"Reach the gate\", \"x\": "
+            << roll(0, size - 1) << ", \"y\": " << roll(0, size - 1) << "}]";
+        out << ", \"lose_conditions\": [\"all_players_defeated\"]}";
+    }
+    out << "]}\n";
+    return static_cast<bool>(out);
+}
+
+// ---- suite ----
+
+long readStatusKilobytes(const char* field) {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    const size_t length = std::char_traits<char>::length(field);
+    while (std::getline(status, line)) {
+        if (line.compare(0, length, field) == 0) {
+            return std::atol(line.c_str() + length);
+        }
+    }
+    return -1;
+}
+
+// Lets VmHWM report the peak of the next phase alone.
+void resetPeakRss() {
+    std::ofstream clear("/proc/self/clear_refs");
+    clear << "5";
+}
+
+struct PhaseResult {
+    std::string phase;
+    int iterations = 0;
+    double meanMs = 0.0;
+    double minMs = 0.0;
+    uint64_t allocations = 0;
+    uint64_t allocatedBytes = 0;
+    long peakRssKb = 0;
+    long rssGrowthKb = 0;
+};
+
+template <typename Fn>
+PhaseResult measurePhase(const char* phase, int iterations, Fn&& fn) {
+    PhaseResult result;
+    result.phase = phase;
+    result.iterations = iterations;
+    resetPeakRss();
+    long startRss = readStatusKilobytes("VmRSS:");
+    uint64_t startCount = allocationCount.load();
+    uint64_t startBytes = allocatedBytes.load();
+    double total = 0.0;
+    result.minMs = 1e300;
+    for (int i = 0; i < iterations; ++i) {
+        auto start = Clock::now();
+        fn();
+        std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+        total += elapsed.count();
+        result.minMs = std::min(result.minMs, elapsed.count());
+    }
+    result.meanMs = total / iterations;
+    result.allocations = (allocationCount.load() - startCount) / iterations;
+    result.allocatedBytes = (allocatedBytes.load() - startBytes) / iterations;
+    result.peakRssKb = readStatusKilobytes("VmHWM:");
+    result.rssGrowthKb = result.peakRssKb - startRss;
+    return result;
+}
+
+std::vector<PhaseResult> measureFile(const std::string& path, int iterations) {
+    std::vector<PhaseResult> results;
+    size_t sink = 0;
+    results.push_back(measurePhase("parse_dom", iterations, [&] { sink += parseMapped(path); }));
+    results.push_back(measurePhase("parse_sax", iterations, [&] {
+        MappedFile file;
+        file.open(path);
+        CountingJsonHandler handler;
+        SimpleJsonParser parser(file.view());
+        parser.parse(handler);
+        sink += handler.events;
+    }));
+    // The structural index alone with each classifier this CPU supports.
+    const std::string defaultKernel = JsonStructuralIndex::getKernelName();
+    for (const char* kernel : {"avx2", "sse2", "scalar"}) {
+        if (!JsonStructuralIndex::setKernel(kernel)) {
+            continue;
+        }
+        const std::string phase = std::string("stage1_") + kernel;
+        results.push_back(measurePhase(phase.c_str(), iterations, [&] {
+            MappedFile file;
+            file.open(path);
+            JsonStructuralIndex index(file.view());
+            for (size_t position = 0; (position = index.nextAtOrAfter(position)) < file.view().size(); ++position) {
+                sink++;
+            }
+        }));
+    }
+    JsonStructuralIndex::setKernel(defaultKernel.c_str());
+    results.push_back(measurePhase("index_records", iterations, [&] {
+        MappedFile file;
+        file.open(path);
+        std::vector<ContentRecordSpan> records;
+        GameDataLoader::indexRecords(file.view(), records);
+        sink += records.size();
+    }));
+    results.push_back(measurePhase("load_json", iterations, [&] {
+        MappedFile file;
+        file.open(path);
+        GameDataLoader loader;
+        loader.loadFromJson(file.view());
+        sink += loader.getContent()->maps->size();
+    }));
+    // Same load with a fixed thread count, counting the calling thread; one
+    // thread streams instead of splitting records.
+    for (size_t threads : {1, 2, 4, 8}) {
+        const std::string phase = "load_json_threads_" + std::to_string(threads);
+        results.push_back(measurePhase(phase.c_str(), iterations, [&] {
+            MappedFile file;
+            file.open(path);
+            GameDataLoader loader;
+            loader.setWorkerThreads(threads - 1);
+            loader.loadFromJson(file.view());
+            sink += loader.getContent()->maps->size();
+        }));
+    }
+    results.push_back(measurePhase("build_pack", iterations, [&] {
+        sink += GameDataLoader().buildPack(path) ? 1 : 0;
+    }));
+    results.push_back(measurePhase("load_pack", iterations, [&] {
+        GameDataLoader loader;
+        loader.loadFromFile(path);
+        sink += loader.getContent()->maps->size();
+    }));
+    results.push_back(measurePhase("load_pack_first_map", iterations, [&] {
+        GameDataLoader loader;
+        loader.loadFromFile(path);
+        const MapCatalog& maps = *loader.getContent()->maps;
+        if (!maps.empty() && maps.get(maps.getOrder().front())) {
+            sink++;
+        }
+    }));
+    if (sink == 0) {
+        std::cerr << "Benchmark produced no content for " << path << std::endl;
+    }
+    return results;
+}
+
+void writeResultLine(std::ostream& out, const std::string& variant, const GeneratorOptions& options,
+                     size_t bytes, const PhaseResult& result) {
+    char line[640];
+    std::snprintf(line, sizeof(line),
+                  "{\"variant\":\"%s\",\"bytes\":%zu,\"maps\":%d,\"map_size\":%d,\"entities\":%d,\"abilities\":%d,"
+                  "\"phase\":\"%s\",\"iterations\":%d,\"mean_ms\":%.3f,\"min_ms\":%.3f,\"allocations\":%llu,"
+                  "\"allocated_bytes\":%llu,\"peak_rss_kb\":%ld,\"rss_growth_kb\":%ld}",
+                  variant.c_str(), bytes, options.maps, options.mapSize, options.entities, options.abilities,
+                  result.phase.c_str(), result.iterations, result.meanMs, result.minMs,
+                  static_cast<unsigned long long>(result.allocations),
+                  static_cast<unsigned long long>(result.allocatedBytes), result.peakRssKb, result.rssGrowthKb);
+    out << line << "\n";
+}
+
+std::string packPathFor(const std::string& path) {
+    size_t dot = path.find_last_of('.');
+    return (dot == std::string::npos ? path : path.substr(0, dot)) + ".edpak";
+}
+
+int runSuite(const std::vector<GeneratorOptions>& variants, const std::string& directory, const std::string& outPath,
+             int iterations, bool keepFiles) {
+    std::ofstream file;
+    if (!outPath.empty()) {
+        file.open(outPath, std::ios::trunc);
+        if (!file) {
+            std::cerr << "Unable to write " << outPath << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = outPath.empty() ? std::cout : file;
+
+    for (const GeneratorOptions& options : variants) {
+        const std::string variant = describe(options);
+        const std::string path = directory + "/content_benchmark_" + variant + ".json";
+        if (!writeSyntheticContent(path, options)) {
+            return 1;
+        }
+        MappedFile probe;
+        probe.open(path);
+        const size_t bytes = probe.getSize();
+        probe.close();
+
+        std::cerr << variant << ": " << bytes / 1024 << " KB" << std::endl;
+        for (const PhaseResult& result : measureFile(path, iterations)) {
+            writeResultLine(out, variant, options, bytes, result);
+            std::cerr << "  " << result.phase << ": " << result.meanMs << " ms, " << result.allocations
+                      << " allocations, peak " << result.peakRssKb / 1024 << " MB" << std::endl;
+        }
+        out.flush();
+        if (!keepFiles) {
+            std::remove(path.c_str());
+            std::remove(packPathFor(path).c_str());
+        }
+    }
+    return 0;
+}
+
+std::vector<GeneratorOptions> defaultMatrix() {
+    std::vector<GeneratorOptions> variants(4);
+    variants[0].maps = 1;
+    variants[0].mapSize = 64;
+    variants[0].entities = 100;
+    variants[0].abilities = 100;
+    variants[1].maps = 16;
+    variants[1].mapSize = 128;
+    variants[1].entities = 1000;
+    variants[1].abilities = 1000;
+    variants[2].maps = 64;
+    variants[2].mapSize = 256;
+    variants[2].entities = 2000;
+    variants[2].abilities = 2000;
+    variants[3].maps = 2;
+    variants[3].mapSize = 1024;
+    variants[3].entities = 5000;
+    variants[3].abilities = 5000;
+    return variants;
+}
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    if (args.empty() || (args[0] != "--generate" && args[0] != "--suite")) {
+        std::string path = !args.empty() ? args[0] : "data/game_data.json";
+        int iterations = args.size() > 1 ? std::max(1, std::atoi(args[1].c_str())) : 200;
+        return runQuick(path, iterations);
+    }
+
+    GeneratorOptions options;
+    bool customVariant = false;
+    std::string generatePath;
+    std::string outPath;
+    const char* tmp = std::getenv("TMPDIR");
+    std::string directory = tmp ? tmp : "/tmp";
+    int iterations = 3;
+    bool keepFiles = false;
+    size_t i = 0;
+    if (args[0] == "--generate") {
+        if (args.size() < 2) {
+            std::cerr << "--generate needs an output path" << std::endl;
+            return 1;
+        }
+        generatePath = args[1];
+        i = 2;
+    } else {
+        i = 1;
+    }
+    for (; i < args.size(); ++i) {
+        const std::string& flag = args[i];
+        if (flag == "--keep") {
+            keepFiles = true;
+            continue;
+        }
+        if (i + 1 >= args.size()) {
+            std::cerr << "Missing value for " << flag << std::endl;
+            return 1;
+        }
+        const std::string& value = args[++i];
+        int number = std::atoi(value.c_str());
+        if (flag == "--maps") {
+            options.maps = std::max(0, number);
+            customVariant = true;
+        } else if (flag == "--map-size") {
+            options.mapSize = std::min(1024, std::max(1, number));
+            customVariant = true;
+        } else if (flag == "--entities") {
+            options.entities = std::max(0, number);
+            customVariant = true;
+        } else if (flag == "--abilities") {
+            options.abilities = std::max(0, number);
+            customVariant = true;
+        } else if (flag == "--seed") {
+            options.seed = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+        } else if (flag == "--iterations") {
+            iterations = std::max(1, number);
+        } else if (flag == "--out") {
+            outPath = value;
+        } else if (flag == "--dir") {
+            directory = value;
+        } else {
+            std::cerr << "Unknown option " << flag << std::endl;
+            return 1;
+        }
+    }
+
+    if (!generatePath.empty()) {
+        return writeSyntheticContent(generatePath, options) ? 0 : 1;
+    }
+    std::vector<GeneratorOptions> variants = customVariant ? std::vector<GeneratorOptions>{options} : defaultMatrix();
+    if (!customVariant) {
+        for (auto& variant : variants) {
+            variant.seed = options.seed;
+        }
+    }
+    return runSuite(variants, directory, outPath, iterations, keepFiles);
+}
@@ -0,0 +1,568 @@
+// Movement benchmarks on generated mixed-terrain maps. Built from the
+// repository root:
+//   g++ -std=c++17 -O2 -I. tools/MovementBenchmark.cpp MovementField.cpp HierarchicalPathfinder.cpp FlowField.cpp BitBoard.cpp Map.cpp Camera.cpp RenderBatcher.cpp MapCatalog.cpp Symbol.cpp -lSDL2 -o movement_benchmark
+//   ./movement_benchmark [--mode range] [--size N] [--origins N] [--units N] [--seed N] [--ap N]...
+//       The old FIFO search against MovementField. Prints one JSON line per
+//       AP budget and method, and fails if the two searches disagree on any
+//       tile.
+//   ./movement_benchmark --mode paths [--size N] [--origins N] [--seed N] [--ap N]...
+//       HierarchicalPathfinder against a full Dijkstra search between random
+//       tile pairs, on terrain only. Prints the build time, query times and
+//       how much longer the HPA* paths are, then one line per AP budget for
+//       bounded queries. Fails on an invalid path or a reachability mismatch.
+//   ./movement_benchmark --mode reuse [--size N] [--origins N] [--units N] [--seed N] [--ap N]...
+//       Keeps one MovementField per origin while units move around it and
+//       the budget shrinks, as during a turn. Each step either reuses or
+//       recomputes the field, and fails if the result differs from a fresh
+//       compute on any tile.
+//   ./movement_benchmark --mode flow [--size N] [--origins N] [--units N] [--seed N]
+//       One FlowField toward every unit against a heap-based Dijkstra search
+//       from the same sources. Fails if a distance differs, or if walking
+//       down the field from a sampled origin does not cost its distance.
+#include "FlowField.h"
+#include "HierarchicalPathfinder.h"
+#include "Map.h"
+#include "MovementField.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string mode = "range";
+    int size = 256;
+    int origins = 200;
+    int units = 64;
+    uint32_t seed = 1;
+    std::vector<int> budgets;
+};
+
+struct Board {
+    Map map;
+    std::vector<SDL_Point> units;
+};
+
+// Same terrain costs as the shipped data: plain 1, forest 2, mountain 3 and
+// impassable water. A smoothing pass groups terrain into patches.
+bool buildBoard(const Options& options, Board& board) {
+    std::mt19937 rng(options.seed);
+    const char* names[] = {"plain", "forest", "mountain", "water"};
+    const int costs[] = {1, 2, 3, 4};
+    SymbolMap<TerrainTypeDefinition> types;
+    Symbol ids[4];
+    for (int i = 0; i < 4; ++i) {
+        TerrainTypeDefinition type;
+        type.id = internSymbol(names[i]);
+        type.movementCost = costs[i];
+        type.blocksMovement = i == 3;
+        types[type.id] = type;
+        ids[i] = type.id;
+    }
+
+    const int size = options.size;
+    std::vector<int> kinds(static_cast<size_t>(size) * size);
+    std::discrete_distribution<int> pick({50, 22, 16, 12});
+    for (int& kind : kinds) {
+        kind = pick(rng);
+    }
+    std::vector<int> smoothed(kinds.size());
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            int votes[4] = {0, 0, 0, 0};
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    int nx = std::min(size - 1, std::max(0, x + dx));
+                    int ny = std::min(size - 1, std::max(0, y + dy));
+                    votes[kinds[static_cast<size_t>(ny) * size + nx]]++;
+                }
+            }
+            smoothed[static_cast<size_t>(y) * size + x] = static_cast<int>(std::max_element(votes, votes + 4) - votes);
+        }
+    }
+
+    auto definition = std::make_shared<MapDefinition>();
+    definition->id = internSymbol("movement_benchmark");
+    definition->width = size;
+    definition->height = size;
+    definition->terrainIds.assign(size, std::vector<Symbol>(size));
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            definition->terrainIds[y][x] = ids[smoothed[static_cast<size_t>(y) * size + x]];
+        }
+    }
+    if (!board.map.loadFromDefinition(definition, types)) {
+        return false;
+    }
+    board.map.setChunkBudget(static_cast<size_t>(-1));
+
+    std::uniform_int_distribution<int> coordinate(0, size - 1);
+    while (static_cast<int>(board.units.size()) < options.units) {
+        SDL_Point unit = {coordinate(rng), coordinate(rng)};
+        if (!board.map.blocksMovement(unit.x, unit.y)) {
+            board.units.push_back(unit);
+        }
+    }
+    return true;
+}
+
+// The search Game used before MovementField: a fresh grid per call, FIFO
+// order with re-queueing, and a scan of every unit per neighbor.
+std::vector<std::vector<int>> legacyMovementCost(const Board& board, const SDL_Point& origin, int ap, size_t& expansions) {
+    const Map& map = board.map;
+    auto occupied = [&](int x, int y) {
+        for (const SDL_Point& unit : board.units) {
+            if (unit.x == x && unit.y == y) return true;
+        }
+        return false;
+    };
+    std::vector<std::vector<int>> costs(map.getHeight(), std::vector<int>(map.getWidth(), -1));
+    std::queue<SDL_Point> frontier;
+    frontier.push(origin);
+    costs[origin.y][origin.x] = 0;
+    const int dirs[4][2] = {{1,0},{-1,0},{0,1},{0,-1}};
+    while (!frontier.empty()) {
+        SDL_Point current = frontier.front();
+        frontier.pop();
+        expansions++;
+        for (const auto& dir : dirs) {
+            int nx = current.x + dir[0];
+            int ny = current.y + dir[1];
+            if (!map.isInside(nx, ny) || map.blocksMovement(nx, ny)) continue;
+            if (occupied(nx, ny)) continue;
+            int newCost = costs[current.y][current.x] + map.getMovementCost(nx, ny);
+            if (newCost <= ap && (costs[ny][nx] == -1 || newCost < costs[ny][nx])) {
+                costs[ny][nx] = newCost;
+                frontier.push({nx, ny});
+            }
+        }
+    }
+    return costs;
+}
+
+void fieldMovementCost(const Board& board, const BitBoard& occupancy, const SDL_Point& origin, int ap,
+                       MovementField& field) {
+    BitBoard obstacles({origin.x - ap, origin.y - ap, 2 * ap + 1, 2 * ap + 1});
+    board.map.fillMovementBlockers(obstacles);
+    obstacles |= occupancy;
+    field.compute(board.map, obstacles, origin, ap);
+}
+
+void writeResultLine(const Options& options, int ap, const char* method, double meanUs, size_t expansions,
+                     size_t mismatches) {
+    char line[320];
+    std::snprintf(line, sizeof(line),
+                  "{\"map_size\":%d,\"units\":%d,\"origins\":%d,\"ap\":%d,\"method\":\"%s\",\"mean_us\":%.2f,"
+                  "\"expansions_per_search\":%.1f,\"mismatches\":%zu}",
+                  options.size, options.units, options.origins, ap, method, meanUs,
+                  static_cast<double>(expansions) / options.origins, mismatches);
+    std::cout << line << "\n";
+}
+
+std::vector<SDL_Point> pickTiles(const Board& board, int count, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> coordinate(0, board.map.getWidth() - 1);
+    std::vector<SDL_Point> tiles;
+    while (static_cast<int>(tiles.size()) < count) {
+        SDL_Point tile = {coordinate(rng), coordinate(rng)};
+        if (!board.map.blocksMovement(tile.x, tile.y)) {
+            tiles.push_back(tile);
+        }
+    }
+    return tiles;
+}
+
+size_t runRanges(const Options& options, const Board& board) {
+    BitBoard occupancy({0, 0, options.size, options.size});
+    for (const SDL_Point& unit : board.units) {
+        occupancy.set(unit.x, unit.y);
+    }
+    std::vector<SDL_Point> origins = pickTiles(board, options.origins, options.seed + 1);
+
+    size_t totalMismatches = 0;
+    MovementField field;
+    for (int ap : options.budgets) {
+        size_t legacyExpansions = 0;
+        size_t settled = 0;
+        size_t mismatches = 0;
+        auto start = Clock::now();
+        std::vector<std::vector<std::vector<int>>> expected;
+        expected.reserve(origins.size());
+        for (const SDL_Point& origin : origins) {
+            expected.push_back(legacyMovementCost(board, origin, ap, legacyExpansions));
+        }
+        double legacyUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / origins.size();
+
+        start = Clock::now();
+        for (const SDL_Point& origin : origins) {
+            fieldMovementCost(board, occupancy, origin, ap, field);
+        }
+        double fieldUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / origins.size();
+
+        for (size_t i = 0; i < origins.size(); ++i) {
+            fieldMovementCost(board, occupancy, origins[i], ap, field);
+            for (int y = 0; y < options.size; ++y) {
+                for (int x = 0; x < options.size; ++x) {
+                    int cost = field.getCost(x, y);
+                    settled += cost >= 0;
+                    mismatches += cost != expected[i][y][x];
+                }
+            }
+        }
+        writeResultLine(options, ap, "fifo_requeue", legacyUs, legacyExpansions, mismatches);
+        writeResultLine(options, ap, "dial_buckets", fieldUs, settled, mismatches);
+        totalMismatches += mismatches;
+    }
+    return totalMismatches;
+}
+
+// Ten steps per origin, each moving one unit (half of the time near the
+// origin) or spending up to 3 AP.
+size_t runReuse(const Options& options, const Board& board) {
+    std::vector<SDL_Point> units = board.units;
+    BitBoard occupancy({0, 0, options.size, options.size});
+    for (const SDL_Point& unit : units) {
+        occupancy.set(unit.x, unit.y);
+    }
+    std::vector<SDL_Point> origins = pickTiles(board, options.origins, options.seed + 1);
+    std::mt19937 rng(options.seed + 3);
+    std::uniform_int_distribution<int> coordinate(0, options.size - 1);
+    std::uniform_int_distribution<int> offset(-20, 20);
+
+    size_t totalMismatches = 0;
+    MovementField field;
+    MovementField fresh;
+    for (int budget : options.budgets) {
+        size_t reused = 0;
+        size_t recomputed = 0;
+        size_t mismatches = 0;
+        double reuseUs = 0.0;
+        double computeUs = 0.0;
+        for (const SDL_Point& origin : origins) {
+            int ap = budget;
+            fieldMovementCost(board, occupancy, origin, ap, field);
+            for (int step = 0; step < 10; ++step) {
+                if (rng() % 3 == 0) {
+                    ap = std::max(0, ap - static_cast<int>(rng() % 4));
+                } else if (!units.empty()) {
+                    SDL_Point& unit = units[rng() % units.size()];
+                    SDL_Point to = {coordinate(rng), coordinate(rng)};
+                    if (rng() % 2) {
+                        to.x = std::min(options.size - 1, std::max(0, origin.x + offset(rng)));
+                        to.y = std::min(options.size - 1, std::max(0, origin.y + offset(rng)));
+                    }
+                    if (board.map.blocksMovement(to.x, to.y) || occupancy.test(to.x, to.y) ||
+                        (to.x == origin.x && to.y == origin.y)) {
+                        continue;
+                    }
+                    occupancy.clear(unit.x, unit.y);
+                    unit = to;
+                    occupancy.set(unit.x, unit.y);
+                }
+
+                BitBoard obstacles({origin.x - ap, origin.y - ap, 2 * ap + 1, 2 * ap + 1});
+                board.map.fillMovementBlockers(obstacles);
+                obstacles |= occupancy;
+                auto start = Clock::now();
+                bool hit = field.reuse(board.map, obstacles, origin, ap);
+                if (hit) {
+                    reuseUs += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+                    reused++;
+                } else {
+                    field.compute(board.map, obstacles, origin, ap);
+                    computeUs += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+                    recomputed++;
+                }
+
+                fresh.compute(board.map, obstacles, origin, ap);
+                for (int y = origin.y - ap; y <= origin.y + ap; ++y) {
+                    for (int x = origin.x - ap; x <= origin.x + ap; ++x) {
+                        if (field.getCost(x, y) != fresh.getCost(x, y)) {
+                            mismatches++;
+                        }
+                    }
+                }
+            }
+        }
+        char line[320];
+        std::snprintf(line, sizeof(line),
+                      "{\"map_size\":%d,\"units\":%d,\"origins\":%d,\"ap\":%d,\"method\":\"reuse\",\"reused\":%zu,"
+                      "\"recomputed\":%zu,\"reuse_us\":%.2f,\"compute_us\":%.2f,\"mismatches\":%zu}",
+                      options.size, options.units, options.origins, budget, reused, recomputed,
+                      reused ? reuseUs / reused : 0.0, recomputed ? computeUs / recomputed : 0.0, mismatches);
+        std::cout << line << "\n";
+        totalMismatches += mismatches;
+    }
+    return totalMismatches;
+}
+
+// Cost from every tile to its nearest source, paying for each tile entered.
+std::vector<int> sourceDistances(const Map& map, const std::vector<SDL_Point>& sources) {
+    using Entry = std::pair<int, int>;
+    const int width = map.getWidth();
+    std::vector<int> costs(static_cast<size_t>(width) * map.getHeight(), -1);
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> frontier;
+    for (const SDL_Point& source : sources) {
+        costs[source.y * width + source.x] = 0;
+        frontier.push({0, source.y * width + source.x});
+    }
+    const int dirs[4][2] = {{1,0},{-1,0},{0,1},{0,-1}};
+    while (!frontier.empty()) {
+        Entry current = frontier.top();
+        frontier.pop();
+        if (current.first != costs[current.second]) continue;
+        int x = current.second % width;
+        int y = current.second / width;
+        int newCost = current.first + map.getMovementCost(x, y);
+        for (const auto& dir : dirs) {
+            int nx = x + dir[0];
+            int ny = y + dir[1];
+            if (!map.isInside(nx, ny) || map.blocksMovement(nx, ny)) continue;
+            int index = ny * width + nx;
+            if (costs[index] == -1 || newCost < costs[index]) {
+                costs[index] = newCost;
+                frontier.push({newCost, index});
+            }
+        }
+    }
+    return costs;
+}
+
+size_t runFlow(const Options& options, const Board& board) {
+    const int rounds = 5;
+    BitBoard blocked({0, 0, options.size, options.size});
+    board.map.fillMovementBlockers(blocked);
+    FlowField field;
+    auto start = Clock::now();
+    for (int i = 0; i < rounds; ++i) {
+        field.compute(board.map, blocked, board.units);
+    }
+    double fieldMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / rounds;
+
+    start = Clock::now();
+    std::vector<int> expected = sourceDistances(board.map, board.units);
+    double dijkstraMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    size_t mismatches = 0;
+    for (int y = 0; y < options.size; ++y) {
+        for (int x = 0; x < options.size; ++x) {
+            mismatches += field.getDistance(x, y) != expected[static_cast<size_t>(y) * options.size + x];
+        }
+    }
+    size_t walkMismatches = 0;
+    auto nothingTaken = [](int, int) { return false; };
+    for (const SDL_Point& origin : pickTiles(board, options.origins, options.seed + 1)) {
+        SDL_Point at = origin;
+        SDL_Point next;
+        int cost = 0;
+        while (field.descend(at, nothingTaken, next)) {
+            cost += board.map.getMovementCost(next.x, next.y);
+            at = next;
+        }
+        SDL_Point source;
+        bool found = field.findSource(origin, source);
+        if (cost != std::max(0, field.getDistance(origin.x, origin.y)) ||
+            (found && (source.x != at.x || source.y != at.y))) {
+            walkMismatches++;
+        }
+    }
+
+    char line[320];
+    std::snprintf(line, sizeof(line),
+                  "{\"map_size\":%d,\"units\":%d,\"method\":\"flow_field\",\"mean_ms\":%.2f,\"mismatches\":%zu,"
+                  "\"walk_mismatches\":%zu}",
+                  options.size, options.units, fieldMs, mismatches, walkMismatches);
+    std::cout << line << "\n";
+    std::snprintf(line, sizeof(line), "{\"map_size\":%d,\"units\":%d,\"method\":\"dijkstra_heap\",\"mean_ms\":%.2f}",
+                  options.size, options.units, dijkstraMs);
+    std::cout << line << "\n";
+    return mismatches + walkMismatches;
+}
+
+// Exact cost of the cheapest path, or -1 when goal cannot be reached.
+int shortestPathCost(const Map& map, const SDL_Point& start, const SDL_Point& goal) {
+    using Entry = std::pair<int, int>;
+    const int width = map.getWidth();
+    std::vector<int> costs(static_cast<size_t>(width) * map.getHeight(), -1);
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> frontier;
+    costs[start.y * width + start.x] = 0;
+    frontier.push({0, start.y * width + start.x});
+    const int dirs[4][2] = {{1,0},{-1,0},{0,1},{0,-1}};
+    while (!frontier.empty()) {
+        Entry current = frontier.top();
+        frontier.pop();
+        if (current.first != costs[current.second]) continue;
+        int x = current.second % width;
+        int y = current.second / width;
+        if (x == goal.x && y == goal.y) return current.first;
+        for (const auto& dir : dirs) {
+            int nx = x + dir[0];
+            int ny = y + dir[1];
+            if (!map.isInside(nx, ny) || map.blocksMovement(nx, ny)) continue;
+            int newCost = current.first + map.getMovementCost(nx, ny);
+            int index = ny * width + nx;
+            if (costs[index] == -1 || newCost < costs[index]) {
+                costs[index] = newCost;
+                frontier.push({newCost, index});
+            }
+        }
+    }
+    return -1;
+}
+
+// Cost of walking `path` from start, or -1 if a step is not to a passable
+// neighbor.
+int walkCost(const Map& map, SDL_Point from, const std::vector<SDL_Point>& path) {
+    int cost = 0;
+    for (const SDL_Point& tile : path) {
+        if (std::abs(tile.x - from.x) + std::abs(tile.y - from.y) != 1 || map.blocksMovement(tile.x, tile.y)) {
+            return -1;
+        }
+        cost += map.getMovementCost(tile.x, tile.y);
+        from = tile;
+    }
+    return cost;
+}
+
+size_t runPaths(const Options& options, const Board& board) {
+    HierarchicalPathfinder pathfinder;
+    auto start = Clock::now();
+    pathfinder.build(board.map);
+    double buildMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    std::vector<SDL_Point> starts = pickTiles(board, options.origins, options.seed + 1);
+    std::vector<SDL_Point> goals = pickTiles(board, options.origins, options.seed + 2);
+    std::vector<SDL_Point> path;
+    std::vector<bool> found(starts.size());
+    std::vector<int> costs(starts.size(), -1);
+    size_t invalid = 0;
+
+    start = Clock::now();
+    for (size_t i = 0; i < starts.size(); ++i) {
+        found[i] = pathfinder.findPath(starts[i], goals[i], path);
+        if (found[i]) {
+            costs[i] = walkCost(board.map, starts[i], path);
+            bool arrived = path.empty() ? starts[i].x == goals[i].x && starts[i].y == goals[i].y
+                                        : path.back().x == goals[i].x && path.back().y == goals[i].y;
+            invalid += costs[i] < 0 || !arrived;
+        }
+    }
+    double hpaUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / starts.size();
+
+    std::vector<int> optimal(starts.size());
+    start = Clock::now();
+    for (size_t i = 0; i < starts.size(); ++i) {
+        optimal[i] = shortestPathCost(board.map, starts[i], goals[i]);
+    }
+    double dijkstraUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / starts.size();
+
+    size_t reachMismatches = 0;
+    size_t compared = 0;
+    double ratioSum = 0.0;
+    double worstRatio = 1.0;
+    for (size_t i = 0; i < starts.size(); ++i) {
+        if (found[i] != (optimal[i] >= 0)) {
+            reachMismatches++;
+        } else if (found[i] && costs[i] >= 0 && optimal[i] > 0) {
+            double ratio = static_cast<double>(costs[i]) / optimal[i];
+            ratioSum += ratio;
+            worstRatio = std::max(worstRatio, ratio);
+            compared++;
+        }
+    }
+
+    char line[400];
+    std::snprintf(line, sizeof(line),
+                  "{\"map_size\":%d,\"queries\":%d,\"method\":\"hpa\",\"build_ms\":%.1f,\"nodes\":%zu,\"edges\":%zu,"
+                  "\"mean_us\":%.2f,\"mean_cost_ratio\":%.4f,\"worst_cost_ratio\":%.3f,\"invalid\":%zu,"
+                  "\"reach_mismatches\":%zu}",
+                  options.size, options.origins, buildMs, pathfinder.getNodeCount(), pathfinder.getEdgeCount(),
+                  hpaUs, compared ? ratioSum / compared : 1.0, worstRatio, invalid, reachMismatches);
+    std::cout << line << "\n";
+    std::snprintf(line, sizeof(line), "{\"map_size\":%d,\"queries\":%d,\"method\":\"dijkstra\",\"mean_us\":%.2f}",
+                  options.size, options.origins, dijkstraUs);
+    std::cout << line << "\n";
+
+    // Bounded queries, as Game issues them for a unit's AP.
+    for (int ap : options.budgets) {
+        size_t boundedInvalid = 0;
+        start = Clock::now();
+        for (size_t i = 0; i < starts.size(); ++i) {
+            if (pathfinder.findPath(starts[i], goals[i], path, nullptr, ap)) {
+                boundedInvalid += walkCost(board.map, starts[i], path) < 0;
+            }
+        }
+        double boundedUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / starts.size();
+        std::snprintf(line, sizeof(line),
+                      "{\"map_size\":%d,\"queries\":%d,\"ap\":%d,\"method\":\"hpa_bounded\",\"mean_us\":%.2f,"
+                      "\"invalid\":%zu}",
+                      options.size, options.origins, ap, boundedUs, boundedInvalid);
+        std::cout << line << "\n";
+        invalid += boundedInvalid;
+    }
+    return invalid + reachMismatches;
+}
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    std::vector<std::string> args(argv + 1, argv + argc);
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (i + 1 >= args.size()) {
+            std::cerr << "Missing value for " << args[i] << std::endl;
+            return 1;
+        }
+        const std::string& flag = args[i];
+        if (flag == "--mode") {
+            options.mode = args[++i];
+            continue;
+        }
+        int number = std::atoi(args[++i].c_str());
+        if (flag == "--size") {
+            options.size = std::min(1024, std::max(8, number));
+        } else if (flag == "--origins") {
+            options.origins = std::max(1, number);
+        } else if (flag == "--units") {
+            options.units = std::max(0, number);
+        } else if (flag == "--seed") {
+            options.seed = static_cast<uint32_t>(number);
+        } else if (flag == "--ap") {
+            options.budgets.push_back(std::max(1, number));
+        } else {
+            std::cerr << "Unknown option " << flag << std::endl;
+            return 1;
+        }
+    }
+    if (options.budgets.empty()) {
+        options.budgets = {12, 30, 60, 120};
+    }
+
+    Board board;
+    if (!buildBoard(options, board)) {
+        std::cerr << "Failed to build the benchmark map" << std::endl;
+        return 1;
+    }
+    size_t failures = 0;
+    if (options.mode == "range") {
+        failures = runRanges(options, board);
+    } else if (options.mode == "paths") {
+        failures = runPaths(options, board);
+    } else if (options.mode == "reuse") {
+        failures = runReuse(options, board);
+    } else if (options.mode == "flow") {
+        failures = runFlow(options, board);
+    } else {
+        std::cerr << "Unknown mode " << options.mode << std::endl;
+        return 1;
+    }
+    return failures == 0 ? 0 : 1;
+}
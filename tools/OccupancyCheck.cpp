@@ -0,0 +1,182 @@
+// Randomized check of OccupancyGrid against the unit list it mirrors.
+// Built from the repository root:
+//   g++ -std=c++17 -O2 -I. tools/OccupancyCheck.cpp Entity.cpp OccupancyGrid.cpp BitBoard.cpp Symbol.cpp -lSDL2 -o occupancy_check
+//   ./occupancy_check [--steps N] [--units N] [--width N] [--height N] [--seed N]
+//       Moves, damages, heals and rebinds random units, often onto tiles
+//       that are already taken, and compares the grid with a scan of every
+//       unit each 1000 steps: the top unit and faction bits of each tile, and
+//       the units forEachIn visits in a random area. Prints one JSON line and
+//       fails on any difference.
+#include "Entity.h"
+#include "OccupancyGrid.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+struct Options {
+    int steps = 200000;
+    int units = 300;
+    int width = 150;
+    int height = 90;
+    uint32_t seed = 1;
+};
+
+struct Board {
+    OccupancyGrid grid;
+    std::vector<std::unique_ptr<Entity>> units;
+};
+
+// Living units per tile, in unit order.
+std::vector<std::vector<Entity*>> scanTiles(const Options& options, const Board& board) {
+    std::vector<std::vector<Entity*>> tiles(static_cast<size_t>(options.width) * options.height);
+    for (const auto& unit : board.units) {
+        if (unit->isAlive()) {
+            const SDL_Point tile = unit->getPosition();
+            tiles[static_cast<size_t>(tile.y) * options.width + tile.x].push_back(unit.get());
+        }
+    }
+    return tiles;
+}
+
+size_t compareTiles(const Options& options, const Board& board) {
+    std::vector<std::vector<Entity*>> tiles = scanTiles(options, board);
+    size_t mismatches = 0;
+    for (int y = 0; y < options.height; ++y) {
+        for (int x = 0; x < options.width; ++x) {
+            const std::vector<Entity*>& here = tiles[static_cast<size_t>(y) * options.width + x];
+            bool present[kFactionCount] = {false, false, false};
+            int topFaction = kFactionCount;
+            for (Entity* unit : here) {
+                const int faction = static_cast<int>(unit->getFaction());
+                present[faction] = true;
+                topFaction = std::min(topFaction, faction);
+            }
+            Entity* top = board.grid.getEntityAt(x, y);
+            if (here.empty()) {
+                mismatches += top != nullptr;
+            } else if (!top || std::find(here.begin(), here.end(), top) == here.end() ||
+                       static_cast<int>(top->getFaction()) != topFaction) {
+                mismatches++;
+            }
+            for (int faction = 0; faction < kFactionCount; ++faction) {
+                mismatches += board.grid.getMask(static_cast<EntityFaction>(faction)).test(x, y) != present[faction];
+            }
+            mismatches += board.grid.isOccupied(x, y) == here.empty();
+        }
+    }
+    return mismatches;
+}
+
+size_t compareArea(const Board& board, const SDL_Rect& area) {
+    size_t mismatches = 0;
+    for (int faction = 0; faction < kFactionCount; ++faction) {
+        std::vector<Entity*> visited;
+        board.grid.forEachIn(static_cast<EntityFaction>(faction), area, [&](Entity& unit) {
+            visited.push_back(&unit);
+        });
+        std::vector<Entity*> expected;
+        for (const auto& unit : board.units) {
+            const SDL_Point tile = unit->getPosition();
+            if (unit->isAlive() && static_cast<int>(unit->getFaction()) == faction && SDL_PointInRect(&tile, &area)) {
+                expected.push_back(unit.get());
+            }
+        }
+        std::sort(visited.begin(), visited.end());
+        std::sort(expected.begin(), expected.end());
+        mismatches += visited != expected;
+    }
+    return mismatches;
+}
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    std::vector<std::string> args(argv + 1, argv + argc);
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (i + 1 >= args.size()) {
+            std::cerr << "Missing value for " << args[i] << std::endl;
+            return 1;
+        }
+        const std::string& flag = args[i];
+        int number = std::atoi(args[++i].c_str());
+        if (flag == "--steps") {
+            options.steps = std::max(0, number);
+        } else if (flag == "--units") {
+            options.units = std::max(1, number);
+        } else if (flag == "--width") {
+            options.width = std::max(1, number);
+        } else if (flag == "--height") {
+            options.height = std::max(1, number);
+        } else if (flag == "--seed") {
+            options.seed = static_cast<uint32_t>(number);
+        } else {
+            std::cerr << "Unknown option " << flag << std::endl;
+            return 1;
+        }
+    }
+
+    EntityDefinition definitions[kFactionCount];
+    for (int faction = 0; faction < kFactionCount; ++faction) {
+        definitions[faction].faction = static_cast<EntityFaction>(faction);
+        definitions[faction].maxHP = 10;
+    }
+    // Rebinding to this one moves a unit to another faction's mask.
+    EntityDefinition turned = definitions[1];
+    turned.faction = EntityFaction::Players;
+
+    std::mt19937 rng(options.seed);
+    std::uniform_int_distribution<int> column(0, options.width - 1);
+    std::uniform_int_distribution<int> row(0, options.height - 1);
+    Board board;
+    board.grid.reset(options.width, options.height);
+    for (int i = 0; i < options.units; ++i) {
+        board.units.emplace_back(new Entity(definitions[i % kFactionCount], {column(rng), row(rng)}));
+        board.units.back()->setOccupancyGrid(&board.grid);
+    }
+
+    size_t mismatches = 0;
+    size_t checks = 0;
+    for (int step = 0; step < options.steps; ++step) {
+        Entity& unit = *board.units[rng() % board.units.size()];
+        switch (rng() % 6) {
+        case 0:
+        case 1:
+            unit.setPosition(column(rng), row(rng));
+            break;
+        case 2: {
+            // Onto another unit's tile.
+            const SDL_Point tile = board.units[rng() % board.units.size()]->getPosition();
+            unit.setPosition(tile.x, tile.y);
+            break;
+        }
+        case 3:
+            unit.takeDamage(static_cast<int>(rng() % 12));
+            break;
+        case 4:
+            unit.heal(static_cast<int>(rng() % 12));
+            break;
+        case 5:
+            unit.rebindDefinition(rng() % 2 ? turned : definitions[1]);
+            break;
+        }
+        if (step % 1000 == 0) {
+            SDL_Rect area = {column(rng) - 10, row(rng) - 10, 70, 40};
+            mismatches += compareTiles(options, board) + compareArea(board, area);
+            checks++;
+        }
+    }
+    mismatches += compareTiles(options, board) + compareArea(board, {0, 0, options.width, options.height});
+    checks++;
+
+    char line[200];
+    std::snprintf(line, sizeof(line), "{\"steps\":%d,\"units\":%d,\"width\":%d,\"height\":%d,\"checks\":%zu,\"mismatches\":%zu}",
+                  options.steps, options.units, options.width, options.height, checks, mismatches);
+    std::cout << line << "\n";
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,191 @@
+// Hot-reload check: live entities across incremental content reloads.
+// Built from the repository root, with AddressSanitizer to catch reads of a
+// released snapshot:
+//   g++ -std=c++17 -O1 -g -fsanitize=address -pthread -I. tools/ReloadCheck.cpp Entity.cpp OccupancyGrid.cpp BitBoard.cpp GameDataLoader.cpp SimpleJson.cpp JsonStructuralIndex.cpp MappedFile.cpp ContentPack.cpp MapCatalog.cpp Symbol.cpp WorkerPool.cpp -lSDL2 -o reload_check
+//   ./reload_check [data/game_data.json] [--rounds N] [--seed N] [--dir /tmp]
+//       Copies the data file, spawns one entity per entity record and then
+//       rewrites the "hp" of random entity records each round. Every round
+//       reloads with reloadChanged and rebinds the entities the way
+//       Game::reloadContent does. Prints one JSON line and fails when a
+//       reload reports the wrong records or an entity misses its new
+//       definition.
+#include "ContentPack.h"
+#include "Entity.h"
+#include "GameDataLoader.h"
+#include "OccupancyGrid.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+struct Options {
+    std::string source = "data/game_data.json";
+    std::string directory = "/tmp";
+    int rounds = 200;
+    uint32_t seed = 1;
+};
+
+// Where the value of each entity's "hp" field sits in the source text.
+struct HpField {
+    size_t offset;
+    size_t length;
+    int value;
+};
+
+bool findHpFields(const std::string& text, std::vector<HpField>& fields) {
+    const size_t begin = text.find("\"entities\"");
+    const size_t end = text.find("\"maps\"", begin);
+    if (begin == std::string::npos || end == std::string::npos) {
+        return false;
+    }
+    const std::string key = "\"hp\":";
+    for (size_t at = text.find(key, begin); at < end; at = text.find(key, at + 1)) {
+        HpField field;
+        field.offset = at + key.size();
+        field.length = text.find_first_of(",}", field.offset) - field.offset;
+        field.value = std::atoi(text.c_str() + field.offset);
+        fields.push_back(field);
+    }
+    return !fields.empty();
+}
+
+std::string withHpValues(const std::string& text, const std::vector<HpField>& fields) {
+    std::string out;
+    size_t copied = 0;
+    for (const HpField& field : fields) {
+        out.append(text, copied, field.offset - copied);
+        out += std::to_string(field.value);
+        copied = field.offset + field.length;
+    }
+    out.append(text, copied, std::string::npos);
+    return out;
+}
+
+bool writeFile(const std::string& path, const std::string& text) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << text;
+    return static_cast<bool>(out);
+}
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    std::vector<std::string> args(argv + 1, argv + argc);
+    size_t i = 0;
+    if (!args.empty() && args[0].compare(0, 2, "--") != 0) {
+        options.source = args[0];
+        i = 1;
+    }
+    for (; i < args.size(); ++i) {
+        if (i + 1 >= args.size()) {
+            std::cerr << "Missing value for " << args[i] << std::endl;
+            return 1;
+        }
+        const std::string& flag = args[i];
+        const std::string& value = args[++i];
+        if (flag == "--rounds") {
+            options.rounds = std::max(1, std::atoi(value.c_str()));
+        } else if (flag == "--seed") {
+            options.seed = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+        } else if (flag == "--dir") {
+            options.directory = value;
+        } else {
+            std::cerr << "Unknown option " << flag << std::endl;
+            return 1;
+        }
+    }
+
+    std::ifstream in(options.source, std::ios::binary);
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::vector<HpField> fields;
+    if (text.empty() || !findHpFields(text, fields)) {
+        std::cerr << "No entity records with \"hp\" in " << options.source << std::endl;
+        return 1;
+    }
+    const std::string path = options.directory + "/reload_check.json";
+    if (!writeFile(path, withHpValues(text, fields))) {
+        std::cerr << "Unable to write " << path << std::endl;
+        return 1;
+    }
+
+    GameDataLoader loader;
+    if (!loader.loadFromFile(path)) {
+        return 1;
+    }
+    // Held the way Game holds it: the loader copies on write, so this is
+    // the only owner of a snapshot once a reload has replaced it.
+    std::shared_ptr<const GameContent> content = loader.getContent();
+    OccupancyGrid grid;
+    const int side = static_cast<int>(content->entities.size()) + 1;
+    grid.reset(side, side);
+    std::vector<std::unique_ptr<Entity>> entities;
+    for (const auto& entry : content->entities) {
+        const int slot = static_cast<int>(entities.size());
+        entities.emplace_back(new Entity(entry.second, {slot, slot}));
+        entities.back()->setOccupancyGrid(&grid);
+    }
+
+    std::mt19937 rng(options.seed);
+    size_t failures = 0;
+    size_t changedRecords = 0;
+    for (int round = 0; round < options.rounds; ++round) {
+        size_t edited = 0;
+        for (HpField& field : fields) {
+            if (rng() % 3 == 0) {
+                const int value = 20 + static_cast<int>(rng() % 200);
+                edited += value != field.value;
+                field.value = value;
+            }
+        }
+        writeFile(path, withHpValues(text, fields));
+
+        ContentChanges changes;
+        if (!loader.reloadChanged(path, changes)) {
+            failures++;
+            continue;
+        }
+        std::shared_ptr<const GameContent> previous = std::move(content);
+        content = loader.getContent();
+        for (auto& entity : entities) {
+            auto it = content->entities.find(entity->getId());
+            if (it != content->entities.end()) {
+                entity->rebindDefinition(it->second);
+            }
+        }
+        previous.reset();
+
+        failures += changes.entities.size() != edited;
+        changedRecords += changes.entities.size();
+        for (const auto& entity : entities) {
+            auto it = content->entities.find(entity->getId());
+            if (it == content->entities.end() || &entity->getDefinition() != &it->second ||
+                entity->getMaxHP() != std::max(1, it->second.maxHP)) {
+                failures++;
+            }
+        }
+    }
+    // Every hp value in the file must now be live.
+    for (const HpField& field : fields) {
+        bool found = false;
+        for (const auto& entity : entities) {
+            found = found || entity->getDefinition().maxHP == field.value;
+        }
+        failures += !found;
+    }
+
+    std::remove(path.c_str());
+    std::remove(ContentPack::pathFor(path).c_str());
+    char line[200];
+    std::snprintf(line, sizeof(line), "{\"rounds\":%d,\"entities\":%zu,\"changed_records\":%zu,\"failures\":%zu}",
+                  options.rounds, entities.size(), changedRecords, failures);
+    std::cout << line << "\n";
+    return failures == 0 ? 0 : 1;
+}